@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <geofun/geofun.hpp>
+
+using namespace geofun;
+
+
+/**
+ * Reproducible random positions between 60 degrees south and north
+ */
+static PositionArray random_positions(const size_t size, const unsigned seed = 42) {
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<double> latitude(-60.0, 60.0);
+  std::uniform_real_distribution<double> longitude(-180.0, 180.0);
+  PositionArray result(size);
+  for (size_t i = 0; i < size; ++i) {
+    result.set(i, Position(latitude(generator), longitude(generator)));
+  }
+  return result;
+}
+
+
+static void BM_geodesic_inverse(benchmark::State& state) {
+  for (auto _: state) {
+    benchmark::DoNotOptimize(geodesic_inverse(52.0, 4.0, 28.0, -16.6, nullptr));
+  }
+}
+BENCHMARK(BM_geodesic_inverse);
+
+
+static void BM_rhumb_inverse(benchmark::State& state) {
+  for (auto _: state) {
+    benchmark::DoNotOptimize(rhumb_inverse(52.0, 4.0, 28.0, -16.6, nullptr));
+  }
+}
+BENCHMARK(BM_rhumb_inverse);
+
+
+/**
+ * Inverse geodesic kernel asking only for the outputs in Mask
+ */
+template <unsigned Mask>
+static void BM_geodesic_inverse_kernel(benchmark::State& state) {
+  const gl::Geodesic& geodesic = get_wgs84().geodesic();
+  double distance;
+  double azimuth1;
+  double azimuth2;
+  for (auto _: state) {
+    geodesic_inverse_kernel<Mask>(geodesic, 52.0, 4.0, 28.0, -16.6, distance, azimuth1, azimuth2);
+    benchmark::DoNotOptimize(distance);
+    benchmark::DoNotOptimize(azimuth1);
+  }
+}
+BENCHMARK_TEMPLATE(BM_geodesic_inverse_kernel, output_distance);
+BENCHMARK_TEMPLATE(BM_geodesic_inverse_kernel, output_azimuth);
+BENCHMARK_TEMPLATE(BM_geodesic_inverse_kernel, output_all);
+
+
+template <unsigned Mask>
+static void BM_rhumb_inverse_kernel(benchmark::State& state) {
+  const gl::Rhumb& rhumb = get_wgs84().rhumb();
+  double distance;
+  double azimuth;
+  for (auto _: state) {
+    rhumb_inverse_kernel<Mask>(rhumb, 52.0, 4.0, 28.0, -16.6, distance, azimuth);
+    benchmark::DoNotOptimize(distance);
+    benchmark::DoNotOptimize(azimuth);
+  }
+}
+BENCHMARK_TEMPLATE(BM_rhumb_inverse_kernel, output_distance);
+BENCHMARK_TEMPLATE(BM_rhumb_inverse_kernel, output_azimuth);
+BENCHMARK_TEMPLATE(BM_rhumb_inverse_kernel, output_all);
+
+
+/**
+ * Angle reduction of range(0) angles of type T on a single thread. The copy
+ * of the unreduced angles is part of the timing.
+ */
+template <typename T>
+static void BM_angle_mod_array(benchmark::State& state) {
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<T> distribution(T(-1000), T(1000));
+  std::vector<T> angles(state.range(0));
+  for (T& angle: angles) {
+    angle = distribution(generator);
+  }
+  std::vector<T> result(angles.size());
+  for (auto _: state) {
+    std::copy(angles.begin(), angles.end(), result.begin());
+    angle_mod_array(result.data(), static_cast<std::ptrdiff_t>(result.size()), 1);
+    benchmark::DoNotOptimize(result.data());
+  }
+  state.SetItemsProcessed(state.range(0) * state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_angle_mod_array, double)->Arg(100000);
+BENCHMARK_TEMPLATE(BM_angle_mod_array, float)->Arg(100000);
+
+
+static void BM_position_operators(benchmark::State& state) {
+  const Position start(52.0, 4.0);
+  const Position end(28.0, -16.6);
+  for (auto _: state) {
+    const Vector loxo = end - start;
+    const Vector ortho = end / start;
+    benchmark::DoNotOptimize(start + loxo);
+    benchmark::DoNotOptimize(start * ortho);
+  }
+  state.SetItemsProcessed(4 * state.iterations());
+}
+BENCHMARK(BM_position_operators);
+
+
+static void BM_split_ortho(benchmark::State& state) {
+  const Position start(40.64, -73.78);
+  const Vector vector = Position(52.3, 4.77) / start;
+  for (auto _: state) {
+    benchmark::DoNotOptimize(vector.split_ortho(start, static_cast<int>(state.range(0)), nullptr));
+  }
+  state.SetItemsProcessed(state.range(0) * state.iterations());
+}
+BENCHMARK(BM_split_ortho)->Arg(10)->Arg(1000);
+
+
+static void BM_split_loxo(benchmark::State& state) {
+  const Position start(40.64, -73.78);
+  const Vector vector = Position(52.3, 4.77) - start;
+  for (auto _: state) {
+    benchmark::DoNotOptimize(vector.split_loxo(start, static_cast<int>(state.range(0)), nullptr));
+  }
+  state.SetItemsProcessed(state.range(0) * state.iterations());
+}
+BENCHMARK(BM_split_loxo)->Arg(10)->Arg(1000);
+
+
+static void BM_parse_dms(benchmark::State& state) {
+  const std::string latitude = "40°38′23″N";
+  const std::string longitude = "73°46′44″W";
+  for (auto _: state) {
+    benchmark::DoNotOptimize(Position(latitude, longitude));
+  }
+}
+BENCHMARK(BM_parse_dms);
+
+
+static void BM_parse_nmea(benchmark::State& state) {
+  const std::string text = "4038.3833,N,07346.7333,W";
+  Position position;
+  for (auto _: state) {
+    benchmark::DoNotOptimize(parse_nmea(text, position));
+  }
+}
+BENCHMARK(BM_parse_nmea);
+
+
+/**
+ * Orthodromic differences of position arrays, with range(0) positions on
+ * range(1) threads
+ */
+static void BM_position_array_ortho(benchmark::State& state) {
+  const PositionArray positions1 = random_positions(state.range(0), 1);
+  const PositionArray positions2 = random_positions(state.range(0), 2);
+  set_threads(static_cast<int>(state.range(1)));
+  for (auto _: state) {
+    benchmark::DoNotOptimize(positions2 / positions1);
+  }
+  set_threads(0);
+  state.SetItemsProcessed(state.range(0) * state.iterations());
+}
+BENCHMARK(BM_position_array_ortho)
+    ->ArgsProduct({{1000, 100000}, {1, 0}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+
+static void BM_position_array_loxo(benchmark::State& state) {
+  const PositionArray positions1 = random_positions(state.range(0), 1);
+  const PositionArray positions2 = random_positions(state.range(0), 2);
+  set_threads(static_cast<int>(state.range(1)));
+  for (auto _: state) {
+    benchmark::DoNotOptimize(positions2 - positions1);
+  }
+  set_threads(0);
+  state.SetItemsProcessed(state.range(0) * state.iterations());
+}
+BENCHMARK(BM_position_array_loxo)
+    ->ArgsProduct({{1000, 100000}, {1, 0}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+
+static void BM_index_nearest(benchmark::State& state) {
+  const PositionArray positions = random_positions(state.range(0));
+  const PositionIndex index(positions, get_wgs84());
+  int64_t neighbour;
+  double distance;
+  for (auto _: state) {
+    index.nearest(51.5, -0.1, 1, &neighbour, &distance);
+    benchmark::DoNotOptimize(distance);
+  }
+}
+BENCHMARK(BM_index_nearest)->Arg(1000)->Arg(100000);
+
+
+static void BM_polygon_contains(benchmark::State& state) {
+  // Regular polygon of range(0) vertices around the North Sea
+  const size_t size = state.range(0);
+  PositionArray vertices(size);
+  for (size_t i = 0; i < size; ++i) {
+    const double angle = 2.0 * pi * i / size;
+    vertices.set(i, Position(55.0 + 3.0 * std::sin(angle), 3.0 + 5.0 * std::cos(angle)));
+  }
+  const Polygon polygon(vertices, get_wgs84());
+  const LineKind kind = state.range(1) ? LineKind::loxo : LineKind::ortho;
+  for (auto _: state) {
+    benchmark::DoNotOptimize(polygon.contains(54.0, 4.0, kind));
+  }
+}
+BENCHMARK(BM_polygon_contains)->ArgsProduct({{16, 10000}, {0, 1}});
+
+
+BENCHMARK_MAIN();
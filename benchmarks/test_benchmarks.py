@@ -0,0 +1,165 @@
+#!/usr/bin/env python3
+"""
+Benchmarks of the python bindings. Run with
+``pytest benchmarks --benchmark-json=benchmarks.json`` or ``invoke benchmark``.
+"""
+
+import numpy as np
+import pytest
+
+from geofun import (Position, PositionArray, Vector, angle_mod,
+                    distance_matrix, geodesic_azimuth_batch,
+                    geodesic_distance_batch, geodesic_inverse,
+                    geodesic_inverse_batch, haversine_distance,
+                    normalize_positions, parse_positions, rhumb_direct,
+                    rhumb_inverse_batch, set_threads)
+
+pytest.importorskip("pytest_benchmark")
+
+sizes = [1000, 100000]
+threads = [1, 0]
+
+
+def random_positions(size, seed):
+    generator = np.random.default_rng(seed)
+    return np.column_stack(
+        (generator.uniform(-60, 60, size), generator.uniform(-180, 180, size))
+    )
+
+
+def test_geodesic_inverse(benchmark):
+    benchmark(geodesic_inverse, 52, 4, 28, -16.6)
+
+
+def test_rhumb_direct(benchmark):
+    benchmark(rhumb_direct, 52, 4, 225, 1000000)
+
+
+def test_position_operators(benchmark):
+    start = Position(52, 4)
+    end = Position(28, -16.6)
+
+    def operators():
+        start + (end - start)
+        start * (end / start)
+
+    benchmark(operators)
+
+
+@pytest.mark.parametrize("segments", [10, 1000])
+def test_split_ortho(benchmark, segments):
+    start = Position(40.64, -73.78)
+    benchmark(Vector.split_ortho, Position(52.3, 4.77) / start, start, segments)
+
+
+@pytest.mark.parametrize("segments", [10, 1000])
+def test_split_loxo(benchmark, segments):
+    start = Position(40.64, -73.78)
+    benchmark(Vector.split_loxo, Position(52.3, 4.77) - start, start, segments)
+
+
+def test_position_from_string(benchmark):
+    records = ["40°38′23″N 73°46′44″W"] * 1000
+    benchmark(lambda: [Position(record) for record in records])
+
+
+def test_parse_positions(benchmark):
+    records = ["40°38′23″N 73°46′44″W"] * 1000
+    benchmark(parse_positions, records)
+
+
+@pytest.mark.parametrize("size", sizes)
+@pytest.mark.parametrize("threads", threads)
+def test_geodesic_inverse_batch(benchmark, size, threads):
+    positions1 = random_positions(size, 1)
+    positions2 = random_positions(size, 2)
+    out = np.empty((size, 3))
+    benchmark(
+        geodesic_inverse_batch,
+        positions1[:, 0],
+        positions1[:, 1],
+        positions2[:, 0],
+        positions2[:, 1],
+        out=out,
+        threads=threads,
+    )
+
+
+@pytest.mark.parametrize(
+    "function", [geodesic_distance_batch, geodesic_azimuth_batch]
+)
+def test_geodesic_inverse_output(benchmark, function):
+    positions1 = random_positions(100000, 1)
+    positions2 = random_positions(100000, 2)
+    out = np.empty(100000)
+    benchmark(
+        function,
+        positions1[:, 0],
+        positions1[:, 1],
+        positions2[:, 0],
+        positions2[:, 1],
+        out=out,
+        threads=1,
+    )
+
+
+@pytest.mark.parametrize("size", sizes)
+@pytest.mark.parametrize("threads", threads)
+def test_rhumb_inverse_batch(benchmark, size, threads):
+    positions1 = random_positions(size, 1)
+    positions2 = random_positions(size, 2)
+    out = np.empty((size, 3))
+    benchmark(
+        rhumb_inverse_batch,
+        positions1[:, 0],
+        positions1[:, 1],
+        positions2[:, 0],
+        positions2[:, 1],
+        out=out,
+        threads=threads,
+    )
+
+
+@pytest.mark.parametrize("dtype", [np.float64, np.float32])
+def test_angle_mod(benchmark, dtype):
+    angles = np.random.default_rng(1).uniform(-1000, 1000, 100000).astype(dtype)
+    out = np.empty_like(angles)
+    benchmark(angle_mod, angles, out=out, threads=1)
+
+
+def test_normalize_positions(benchmark):
+    positions = random_positions(100000, 1) * 2
+    out = (np.empty(100000), np.empty(100000))
+    benchmark(normalize_positions, positions[:, 0], positions[:, 1], out=out)
+
+
+@pytest.mark.parametrize("size", sizes)
+def test_haversine_distance(benchmark, size):
+    positions1 = random_positions(size, 1)
+    positions2 = random_positions(size, 2)
+    benchmark(
+        haversine_distance,
+        positions1[:, 0],
+        positions1[:, 1],
+        positions2[:, 0],
+        positions2[:, 1],
+    )
+
+
+@pytest.mark.parametrize("size", sizes)
+@pytest.mark.parametrize("threads", threads)
+def test_position_array_ortho(benchmark, size, threads):
+    positions1 = PositionArray(random_positions(size, 1))
+    positions2 = PositionArray(random_positions(size, 2))
+    # Array operators take the number of threads from set_threads
+    set_threads(threads)
+    try:
+        benchmark(lambda: positions2 / positions1)
+    finally:
+        set_threads(0)
+
+
+@pytest.mark.parametrize("threads", threads)
+def test_distance_matrix(benchmark, threads):
+    positions = PositionArray(random_positions(300, 1))
+    benchmark(distance_matrix, positions, threads=threads)
@@ -78,10 +78,16 @@ def build(setup_kwargs):
     ext_modules = [
         Pybind11Extension(
             "geofun",
-            sources=[str(f) for f in sorted(script_dir.glob("src/geofun/*.cpp"))],
-            include_dirs=["contrib/install/include"],
+            sources=[
+                str(f)
+                for f in sorted(script_dir.glob("src/geofun/*.cpp"))
+                + sorted(script_dir.glob("src/geofun/lib/*.cpp"))
+            ],
+            include_dirs=["src/geofun/include", "contrib/install/include"],
             library_dirs=["contrib/install/lib"],
             libraries=["GeographicLib", "fmt"],
+            # Set GEOFUN_STATS=1 to build with counters of the instrumented functions
+            define_macros=[("GEOFUN_STATS", "1")] if os.environ.get("GEOFUN_STATS") else [],
         ),
     ]
     setup_kwargs.update(
@@ -1,859 +1,1612 @@
-#include <string>
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
 #include <stdexcept>
-#include <vector>
 #include <string>
-#include <cstdlib>
-#include <initializer_list>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <pybind11/numpy.h>
 #include <pybind11/operators.h>
 
-#include <GeographicLib/Geodesic.hpp>
-#include <GeographicLib/Rhumb.hpp>
-#include <GeographicLib/Constants.hpp>
-
 #include <fmt/format.h>
+#include <fmt/ranges.h>
+
+#include <geofun/geofun.hpp>
 
 #include "version.h"
 
-namespace gl = GeographicLib;
 namespace py = pybind11;
 using namespace pybind11::literals;
+using namespace geofun;
 
-static constexpr double pi = 3.14159265358979323846;
-static constexpr double r2d = 180.0 / pi;
-static constexpr double d2r = pi / 180.0;
 
-
-double angle_mod(const double angle) {
-  double result = std::fmod(angle, 360.0);
-  return result < 0.0 ? result + 360.0 : result;
+std::string get_version() {
+  return VERSION;
 }
 
 
-double angle_mod_signed(const double angle) {
-  double result = std::fmod(angle, 360.0);
-  return result < -180.0 ? result + 360.0 : result >= 180.0 ? result - 360.0 : result;
+/**
+ * Get the probe totals as a dict of probe name to dict of calls, items and
+ * time in seconds
+ */
+py::dict stats() {
+  py::dict result;
+  for (const ProbeStats& probe: get_stats()) {
+    py::dict totals;
+    totals["calls"] = probe.calls;
+    totals["items"] = probe.items;
+    totals["time"] = probe.time;
+    result[probe.name] = totals;
+  }
+  return result;
 }
 
 
-double angle_diff(const double angle1, const double angle2) {
-  return angle_mod_signed(angle1 - angle2);
-}
+using DoubleArray = py::array_t<double, py::array::c_style | py::array::forcecast>;
+using OutputArray = py::array_t<double, py::array::c_style>;
 
 
-inline bool floats_equal(const double value1, const double value2)
-{
-  double abs1 = std::fabs(value1);
-  double abs2 = std::fabs(value2);
-  double absmax = std::max(abs1, abs2);
-  double eps = 1E-13;
-  // Get relative eps value except for values very close to zero
-  if (absmax > 1E-7) {
-    eps *= absmax;
-  }
-  return std::fabs(value1 - value2) < eps;
+/**
+ * Get the numpy module, imported once
+ */
+const py::module_& get_numpy() {
+  // Never destroyed, as the interpreter may be gone by then
+  static const py::module_* numpy = new py::module_(py::module_::import("numpy"));
+  return *numpy;
 }
 
 
-inline bool float_smaller(const double value1, const double value2)
-{
-  return value1 < value2 and not floats_equal(value1, value2);
+std::vector<py::ssize_t> get_shape(const py::array& array) {
+  return std::vector<py::ssize_t>(array.shape(), array.shape() + array.ndim());
 }
 
 
-inline bool scan_floats(std::vector<double>& values, const std::string input) {
-  const char* s = input.c_str();
-  int result = true;
-
-  // Scan if the string only contains integral values
-  int i = 0;
-  char c;
-  while ((c = s[i++]) != '\0') {
-    if (!(isspace(c) || isdigit(c) || (c == '-'))) {
-      result = false;
-      break;
+/**
+ * Input arrays of a batch operation broadcast against each other following
+ * the numpy rules. Walks the flat index range of the broadcast shape and
+ * passes the corresponding input values to a kernel.
+ */
+template <size_t N>
+struct Broadcast {
+  Broadcast(const std::array<const DoubleArray*, N>& arrays): shape(), size(1), data(), strides(), steps(), simple(true) {
+    py::ssize_t ndim = 0;
+    for (auto array: arrays) {
+      ndim = std::max(ndim, array->ndim());
+    }
+    shape.assign(ndim, 1);
+    for (auto array: arrays) {
+      py::ssize_t offset = ndim - array->ndim();
+      for (py::ssize_t d = 0; d < array->ndim(); ++d) {
+        py::ssize_t extent = array->shape(d);
+        if (extent != 1) {
+          if (shape[offset + d] != 1 && shape[offset + d] != extent) {
+            throw std::invalid_argument(fmt::format(
+                "Batch arguments with shapes ({}) and ({}) can't be broadcast together",
+                fmt::join(get_shape(*array), ", "), fmt::join(shape, ", ")));
+          }
+          shape[offset + d] = extent;
+        }
+      }
+    }
+    for (auto extent: shape) {
+      size *= extent;
+    }
+    for (size_t k = 0; k < N; ++k) {
+      const DoubleArray& array = *arrays[k];
+      data[k] = array.data();
+      strides[k].assign(ndim, 0);
+      py::ssize_t offset = ndim - array.ndim();
+      py::ssize_t stride = 1;
+      for (py::ssize_t d = array.ndim() - 1; d >= 0; --d) {
+        py::ssize_t extent = array.shape(d);
+        strides[k][offset + d] = extent == 1 ? 0 : stride;
+        stride *= extent;
+      }
+      // Arrays that are either scalar or of full size can be walked by flat index
+      steps[k] = array.size() == 1 ? 0 : 1;
+      simple &= array.size() == 1 || array.size() == size;
     }
   }
 
-  // Now scan the string for floats
-  while (*s != '\0') {
-    char* e;
-    double f = std::strtof(s, &e);
-    if (e == s) {
-      ++e;
+  /**
+   * Call kernel(i, values) for flat indices i in [begin, end), where values
+   * holds the N input values at that index
+   */
+  template <typename Kernel>
+  void apply(const py::ssize_t begin, const py::ssize_t end, Kernel kernel) const {
+    std::array<double, N> values;
+    if (simple) {
+      for (py::ssize_t i = begin; i < end; ++i) {
+        for (size_t k = 0; k < N; ++k) {
+          values[k] = data[k][i * steps[k]];
+        }
+        kernel(i, values);
+      }
+      return;
     }
-    else {
-      values.push_back(f);
+    // General case: keep a running multi-dimensional index
+    const py::ssize_t ndim = static_cast<py::ssize_t>(shape.size());
+    std::vector<py::ssize_t> index(ndim, 0);
+    std::array<py::ssize_t, N> offsets{};
+    py::ssize_t remainder = begin;
+    for (py::ssize_t d = ndim - 1; d >= 0; --d) {
+      index[d] = remainder % shape[d];
+      remainder /= shape[d];
+      for (size_t k = 0; k < N; ++k) {
+        offsets[k] += index[d] * strides[k][d];
+      }
+    }
+    for (py::ssize_t i = begin; i < end; ++i) {
+      for (size_t k = 0; k < N; ++k) {
+        values[k] = data[k][offsets[k]];
+      }
+      kernel(i, values);
+      for (py::ssize_t d = ndim - 1; d >= 0; --d) {
+        ++index[d];
+        for (size_t k = 0; k < N; ++k) {
+          offsets[k] += strides[k][d];
+        }
+        if (index[d] < shape[d]) {
+          break;
+        }
+        for (size_t k = 0; k < N; ++k) {
+          offsets[k] -= shape[d] * strides[k][d];
+        }
+        index[d] = 0;
+      }
     }
-    s = e;
+  }
+
+  std::vector<py::ssize_t> shape;
+  py::ssize_t size;
+  std::array<const double*, N> data;
+  std::array<std::vector<py::ssize_t>, N> strides;
+  std::array<py::ssize_t, N> steps;
+  bool simple;
+};
+
+
+OutputArray output_array(const py::object& out, const std::vector<py::ssize_t>& shape) {
+  if (out.is_none()) {
+    return OutputArray(shape);
+  }
+  if (!py::isinstance<OutputArray>(out)) {
+    throw std::invalid_argument("Output array should be a C contiguous array of float64");
+  }
+  auto result = py::reinterpret_borrow<OutputArray>(out);
+  if (get_shape(result) != shape) {
+    throw std::invalid_argument(fmt::format("Output array should have shape ({})", fmt::join(shape, ", ")));
+  }
+  if (!result.writeable()) {
+    throw std::invalid_argument("Output array should be writeable");
   }
   return result;
 }
 
 
-std::string get_version() {
-  return VERSION;
+OutputArray output_array(const py::object& out, std::vector<py::ssize_t> shape, const py::ssize_t width) {
+  shape.push_back(width);
+  return output_array(out, shape);
 }
 
 
-py::tuple rhumb_direct(const double latitude, const double longitude, const double azimuth, const double distance) {
-  static const gl::Rhumb& rhumb = gl::Rhumb::WGS84();
-  double out_latitude;
-  double out_longitude;
-  rhumb.Direct(latitude, longitude, azimuth, distance, out_latitude, out_longitude);
-  return py::make_tuple(out_latitude, out_longitude, azimuth);
+/**
+ * Run kernel over all elements of a broadcast without holding the GIL
+ */
+template <size_t N, typename Kernel>
+void run_batch(const Broadcast<N>& broadcast, const int threads, Kernel kernel) {
+  py::gil_scoped_release release;
+  parallel_for(broadcast.size, threads, [&](const py::ssize_t begin, const py::ssize_t end) {
+    broadcast.apply(begin, end, kernel);
+  });
 }
 
 
-py::tuple rhumb_inverse(const double latitude1, const double longitude1, const double latitude2, const double longitude2) {
-  static const gl::Rhumb& rhumb = gl::Rhumb::WGS84();
-  double azimuth;
-  double distance;
-  rhumb.Inverse(latitude1, longitude1, latitude2, longitude2, distance, azimuth);
-  return py::make_tuple(azimuth, distance, azimuth);
+OutputArray rhumb_direct_batch(
+    const DoubleArray& latitude, const DoubleArray& longitude,
+    const DoubleArray& azimuth, const DoubleArray& distance,
+    const py::object& out, const int threads, const Ellipsoid* ellipsoid) {
+  const gl::Rhumb& rhumb = get_ellipsoid(ellipsoid).rhumb();
+  Broadcast<4> broadcast({&latitude, &longitude, &azimuth, &distance});
+  GEOFUN_PROBE(rhumb_direct_batch, broadcast.size);
+  auto result = output_array(out, broadcast.shape, 3);
+  double* values = result.mutable_data();
+  run_batch(broadcast, threads, [&](const py::ssize_t i, const std::array<double, 4>& args) {
+    double* value = values + 3 * i;
+    rhumb.Direct(args[0], args[1], args[2], args[3], value[0], value[1]);
+    value[2] = args[2];
+  });
+  return result;
 }
 
 
-py::tuple geodesic_direct(const double latitude, const double longitude, const double azimuth, const double distance) {
-  static const gl::Geodesic& geodesic = gl::Geodesic::WGS84();
-  double out_latitude;
-  double out_longitude;
-  double out_azimuth;
-  geodesic.Direct(latitude, longitude, azimuth, distance, out_latitude, out_longitude, out_azimuth);
-  return py::make_tuple(out_latitude, out_longitude, out_azimuth);
+OutputArray rhumb_inverse_batch(
+    const DoubleArray& latitude1, const DoubleArray& longitude1,
+    const DoubleArray& latitude2, const DoubleArray& longitude2,
+    const py::object& out, const int threads, const Ellipsoid* ellipsoid) {
+  const gl::Rhumb& rhumb = get_ellipsoid(ellipsoid).rhumb();
+  Broadcast<4> broadcast({&latitude1, &longitude1, &latitude2, &longitude2});
+  GEOFUN_PROBE(rhumb_inverse_batch, broadcast.size);
+  auto result = output_array(out, broadcast.shape, 3);
+  double* values = result.mutable_data();
+  run_batch(broadcast, threads, [&](const py::ssize_t i, const std::array<double, 4>& args) {
+    double* value = values + 3 * i;
+    rhumb.Inverse(args[0], args[1], args[2], args[3], value[1], value[0]);
+    value[2] = value[0];
+  });
+  return result;
 }
 
 
-py::tuple geodesic_inverse(const double latitude1, const double longitude1, const double latitude2, const double longitude2) {
-  static const gl::Geodesic& geodesic = gl::Geodesic::WGS84();
-  double azimuth1;
-  double distance;
-  double azimuth2;
-  geodesic.Inverse(latitude1, longitude1, latitude2, longitude2, distance, azimuth1, azimuth2);
-  return py::make_tuple(azimuth1, distance, azimuth2);
+OutputArray geodesic_direct_batch(
+    const DoubleArray& latitude, const DoubleArray& longitude,
+    const DoubleArray& azimuth, const DoubleArray& distance,
+    const py::object& out, const int threads, const Ellipsoid* ellipsoid) {
+  const gl::Geodesic& geodesic = get_ellipsoid(ellipsoid).geodesic();
+  Broadcast<4> broadcast({&latitude, &longitude, &azimuth, &distance});
+  GEOFUN_PROBE(geodesic_direct_batch, broadcast.size);
+  auto result = output_array(out, broadcast.shape, 3);
+  double* values = result.mutable_data();
+  run_batch(broadcast, threads, [&](const py::ssize_t i, const std::array<double, 4>& args) {
+    double* value = values + 3 * i;
+    geodesic.Direct(args[0], args[1], args[2], args[3], value[0], value[1], value[2]);
+  });
+  return result;
 }
 
 
-struct Vector;
-struct Position;
-
-struct Point {
-  Point() = default;
-  Point(const Point&) = default;
-  Point(Point&&) = default;
-  Point(const double x, const double y): x_(x), y_(y) {}
-  Point(const std::vector<double>& initializer) {
-    if (initializer.size() != 2) {
-      throw std::out_of_range("Initializer length isn't 2 in construction of point");
-    }
-    set_x(initializer[0]);
-    set_y(initializer[1]);
-  }
-  Point& operator=(const Point&) = default;
-  Point& operator=(Point&&) = default;
+OutputArray geodesic_inverse_batch(
+    const DoubleArray& latitude1, const DoubleArray& longitude1,
+    const DoubleArray& latitude2, const DoubleArray& longitude2,
+    const py::object& out, const int threads, const Ellipsoid* ellipsoid) {
+  const gl::Geodesic& geodesic = get_ellipsoid(ellipsoid).geodesic();
+  Broadcast<4> broadcast({&latitude1, &longitude1, &latitude2, &longitude2});
+  GEOFUN_PROBE(geodesic_inverse_batch, broadcast.size);
+  auto result = output_array(out, broadcast.shape, 3);
+  double* values = result.mutable_data();
+  run_batch(broadcast, threads, [&](const py::ssize_t i, const std::array<double, 4>& args) {
+    double* value = values + 3 * i;
+    geodesic.Inverse(args[0], args[1], args[2], args[3], value[1], value[0], value[2]);
+  });
+  return result;
+}
 
-  double get_x() const {
-    return x_;
-  }
 
-  double get_y() const {
-    return y_;
-  }
+/**
+ * Get a single output of the inverse solutions, either the distance or the
+ * initial azimuth, so GeographicLib doesn't compute the terms of the other
+ */
+template <unsigned Mask>
+OutputArray geodesic_inverse_output(
+    const Broadcast<4>& broadcast, const py::object& out, const int threads, const Ellipsoid* ellipsoid) {
+  static_assert(Mask == output_distance || Mask == output_azimuth, "Single output expected");
+  const gl::Geodesic& geodesic = get_ellipsoid(ellipsoid).geodesic();
+  auto result = output_array(out, broadcast.shape);
+  double* values = result.mutable_data();
+  run_batch(broadcast, threads, [&](const py::ssize_t i, const std::array<double, 4>& args) {
+    double distance;
+    double azimuth1;
+    double azimuth2;
+    geodesic_inverse_kernel<Mask>(geodesic, args[0], args[1], args[2], args[3], distance, azimuth1, azimuth2);
+    values[i] = Mask == output_distance ? distance : azimuth1;
+  });
+  return result;
+}
 
-  Point& set_x(const double x) {
-    x_ = x;
-    return *this;
-  }
 
-  Point& set_y(const double y) {
-    y_ = y;
-    return *this;
-  }
+template <unsigned Mask>
+OutputArray rhumb_inverse_output(
+    const Broadcast<4>& broadcast, const py::object& out, const int threads, const Ellipsoid* ellipsoid) {
+  static_assert(Mask == output_distance || Mask == output_azimuth, "Single output expected");
+  const gl::Rhumb& rhumb = get_ellipsoid(ellipsoid).rhumb();
+  auto result = output_array(out, broadcast.shape);
+  double* values = result.mutable_data();
+  run_batch(broadcast, threads, [&](const py::ssize_t i, const std::array<double, 4>& args) {
+    double distance;
+    double azimuth;
+    rhumb_inverse_kernel<Mask>(rhumb, args[0], args[1], args[2], args[3], distance, azimuth);
+    values[i] = Mask == output_distance ? distance : azimuth;
+  });
+  return result;
+}
 
-  bool operator==(const Point& point) const {
-    return floats_equal(x_, point.x_) && floats_equal(y_, point.y_);
-  }
 
-  bool operator==(const std::vector<double>& other) const {
-    if (other.size() != 2) {
-      throw std::out_of_range(fmt::format("Can't compare Point to container of size {}", other.size()));
-    }
-    return floats_equal(get_x(), other[0]) && floats_equal(get_y(), other[1]);
-  }
+OutputArray geodesic_distance_batch(
+    const DoubleArray& latitude1, const DoubleArray& longitude1,
+    const DoubleArray& latitude2, const DoubleArray& longitude2,
+    const py::object& out, const int threads, const Ellipsoid* ellipsoid) {
+  Broadcast<4> broadcast({&latitude1, &longitude1, &latitude2, &longitude2});
+  GEOFUN_PROBE(geodesic_distance_batch, broadcast.size);
+  return geodesic_inverse_output<output_distance>(broadcast, out, threads, ellipsoid);
+}
 
-  Point& operator+=(const Point& point) {
-    x_ += point.x_;
-    y_ += point.y_;
-    return *this;
-  }
 
-  Point& operator-=(const Point& point) {
-    x_ -= point.x_;
-    y_ -= point.y_;
-    return *this;
-  }
+OutputArray geodesic_azimuth_batch(
+    const DoubleArray& latitude1, const DoubleArray& longitude1,
+    const DoubleArray& latitude2, const DoubleArray& longitude2,
+    const py::object& out, const int threads, const Ellipsoid* ellipsoid) {
+  Broadcast<4> broadcast({&latitude1, &longitude1, &latitude2, &longitude2});
+  GEOFUN_PROBE(geodesic_azimuth_batch, broadcast.size);
+  return geodesic_inverse_output<output_azimuth>(broadcast, out, threads, ellipsoid);
+}
 
-  Point& operator+=(const Vector& vector);
-  Point& operator-=(const Vector& vector);
 
-  Point operator+(const Point& point) const {
-    Point result(*this);
-    result += point;
-    return result;
-  }
+OutputArray rhumb_distance_batch(
+    const DoubleArray& latitude1, const DoubleArray& longitude1,
+    const DoubleArray& latitude2, const DoubleArray& longitude2,
+    const py::object& out, const int threads, const Ellipsoid* ellipsoid) {
+  Broadcast<4> broadcast({&latitude1, &longitude1, &latitude2, &longitude2});
+  GEOFUN_PROBE(rhumb_distance_batch, broadcast.size);
+  return rhumb_inverse_output<output_distance>(broadcast, out, threads, ellipsoid);
+}
 
 
-  Point operator-(const Point& point) const {
-    Point result(*this);
-    result -= point;
-    return result;
-  }
+OutputArray rhumb_azimuth_batch(
+    const DoubleArray& latitude1, const DoubleArray& longitude1,
+    const DoubleArray& latitude2, const DoubleArray& longitude2,
+    const py::object& out, const int threads, const Ellipsoid* ellipsoid) {
+  Broadcast<4> broadcast({&latitude1, &longitude1, &latitude2, &longitude2});
+  GEOFUN_PROBE(rhumb_azimuth_batch, broadcast.size);
+  return rhumb_inverse_output<output_azimuth>(broadcast, out, threads, ellipsoid);
+}
 
-  Point& operator*=(const double multiplier) {
-    x_ *= multiplier;
-    y_ *= multiplier;
-    return *this;
-  }
 
-  Point operator*(const double multiplier) const {
-    Point result(*this);
-    result *= multiplier;
-    return result;
+/**
+ * Add the lines of buffer to texts, without line endings
+ */
+void split_lines(const std::string_view buffer, std::vector<std::string_view>& texts) {
+  size_t begin = 0;
+  while (begin < buffer.size()) {
+    const size_t end = std::min(buffer.find('\n', begin), buffer.size());
+    std::string_view line = buffer.substr(begin, end - begin);
+    if (!line.empty() && line.back() == '\r') {
+      line.remove_suffix(1);
+    }
+    texts.push_back(line);
+    begin = end + 1;
   }
+}
 
-  Point operator-() const {
-    return Point(-x_, -y_);
-  }
 
-  double get_item(int i) const {
-    i = i < 0 ? i + 2 : i;
-    switch(i) {
-      case 0: return get_x();
-      case 1: return get_y();
-      default: throw std::out_of_range(fmt::format("Index {} is out of range for Point", i));
+/**
+ * Parse positions from records of text: the strings or bytes in a sequence, or
+ * the lines of a str, bytes or bytearray. Returns (N, 2) array of latitudes
+ * and longitudes and array of flags telling which records were valid. Invalid
+ * records give NaN instead of throwing.
+ */
+py::tuple parse_positions(const py::object& records, const std::string& format_name, const int threads) {
+  const PositionFormat format = get_position_format(format_name);
+  // Views on the text of each record, which must stay valid without the GIL:
+  // the buffer request keeps a bytearray from being resized and the tuple
+  // keeps the items of a sequence alive when the caller changes it
+  std::vector<std::string_view> texts;
+  py::buffer_info buffer;
+  py::tuple items;
+  if (py::isinstance<py::str>(records)) {
+    py::ssize_t size;
+    const char* data = PyUnicode_AsUTF8AndSize(records.ptr(), &size);
+    if (data == nullptr) {
+      throw py::error_already_set();
     }
+    split_lines(std::string_view(data, size), texts);
   }
-
-  Point& set_item(int i, const double value) {
-    i = i < 0 ? i + 2 : i;
-    switch(i) {
-      case 0: return set_x(value);
-      case 1: return set_y(value);
-      default: throw std::out_of_range(fmt::format("Index {} is out of range for Point", i));
+  else if (py::isinstance<py::bytes>(records) || py::isinstance<py::bytearray>(records)) {
+    buffer = py::reinterpret_borrow<py::buffer>(records).request();
+    split_lines(std::string_view(static_cast<const char*>(buffer.ptr), buffer.size), texts);
+  }
+  else {
+    items = py::reinterpret_steal<py::tuple>(PySequence_Tuple(records.ptr()));
+    if (!items) {
+      throw py::error_already_set();
+    }
+    texts.resize(items.size());
+    for (size_t i = 0; i < texts.size(); ++i) {
+      const py::handle item = items[i];
+      py::ssize_t size;
+      if (py::isinstance<py::str>(item)) {
+        const char* data = PyUnicode_AsUTF8AndSize(item.ptr(), &size);
+        if (data == nullptr) {
+          throw py::error_already_set();
+        }
+        texts[i] = std::string_view(data, size);
+      }
+      else if (py::isinstance<py::bytes>(item)) {
+        char* data;
+        PyBytes_AsStringAndSize(item.ptr(), &data, &size);
+        texts[i] = std::string_view(data, size);
+      }
+      // Anything else stays empty, so invalid
     }
   }
 
-  constexpr int get_len() const {
-    return 2;
+  const py::ssize_t size = static_cast<py::ssize_t>(texts.size());
+  OutputArray values({size, py::ssize_t(2)});
+  py::array_t<bool> valid(size);
+  double* value = values.mutable_data();
+  bool* is_valid = valid.mutable_data();
+  {
+    py::gil_scoped_release release;
+    parallel_for(size, threads, [&](const py::ssize_t begin, const py::ssize_t end) {
+      for (py::ssize_t i = begin; i < end; ++i) {
+        Position position;
+        int count;
+        const bool parsed = format == PositionFormat::dms
+            ? parse_dms(texts[i], std::string_view(), position, count)
+            : parse_nmea(texts[i], position);
+        is_valid[i] = parsed;
+        value[2 * i] = parsed ? position.get_latitude() : std::numeric_limits<double>::quiet_NaN();
+        value[2 * i + 1] = parsed ? position.get_longitude() : std::numeric_limits<double>::quiet_NaN();
+      }
+    });
   }
+  return py::make_tuple(values, valid);
+}
 
-  double operator[](const int i) {
-    return get_item(i);
-  }
 
-  std::string get_string() const {
-    return fmt::format("{:.3f}, {:.3f}", x_, y_);
+/**
+ * Get (count, 2) array of positions along line at distances distance(i)
+ */
+template <typename Line, typename Distance>
+OutputArray line_positions(const Line& line, const py::ssize_t count, Distance distance, const int threads) {
+  OutputArray result({count, py::ssize_t(2)});
+  double* values = result.mutable_data();
+  {
+    py::gil_scoped_release release;
+    parallel_for(count, threads, [&](const py::ssize_t begin, const py::ssize_t end) {
+      for (py::ssize_t i = begin; i < end; ++i) {
+        line.Position(distance(i), values[2 * i], values[2 * i + 1]);
+      }
+    });
   }
+  return result;
+}
 
-  std::string get_representation() const {
-    double i;
-    double x_frac = modf(x_, &i);
-    double y_frac = modf(y_, &i);
-    std::string format = x_frac == 0.0 ? "Point({:.1f}" : "Point({:.15g}";
-    format += y_frac == 0.0 ? ", {:.1f})" : ", {:.15g})";
-    return fmt::format(fmt::runtime(format), x_, y_);
-  }
 
-private:
-  friend struct Vector;
-  double x_;
-  double y_;
-};
+OutputArray split_ortho_array(const Vector& vector, const Position& start, const int number_of_segments,
+    const int threads, const Ellipsoid* ellipsoid) {
+  const double length = vector.get_length();
+  const int segments = std::max(number_of_segments, 0);
+  return line_positions(ortho_line(vector, start, get_ellipsoid(ellipsoid)), segments + 1,
+      [&](const py::ssize_t i) { return i > 0 ? length * i / segments : 0.0; }, threads);
+}
 
 
-Point operator*(const double multiplier, const Point& point) {
-  return point.operator*(multiplier);
+OutputArray split_loxo_array(const Vector& vector, const Position& start, const int number_of_segments,
+    const int threads, const Ellipsoid* ellipsoid) {
+  const double length = vector.get_length();
+  const int segments = std::max(number_of_segments, 0);
+  return line_positions(loxo_line(vector, start, get_ellipsoid(ellipsoid)), segments + 1,
+      [&](const py::ssize_t i) { return i > 0 ? length * i / segments : 0.0; }, threads);
 }
 
 
-struct Vector {
-  Vector() = default;
-  Vector(const Vector&) = default;
-  Vector(Vector&&) = default;
-  Vector(const double azimuth, const double length): azimuth_(), length_() {
-    set_azimuth(azimuth);
-    set_length(length);
+/**
+ * Sample positions at fixed spacing along the orthodrome of vector from start. The last
+ * sample is the end of the orthodrome, so the last spacing may be shorter.
+ */
+OutputArray sample_ortho(const Vector& vector, const Position& start, const double spacing,
+    const int threads, const Ellipsoid* ellipsoid) {
+  // 16 GB of output, which also keeps the sample count well within py::ssize_t
+  constexpr double max_samples = 1e9;
+  if (!(spacing > 0.0)) {
+    throw std::invalid_argument(fmt::format("Invalid spacing: {}", spacing));
   }
-  Vector(const Point& point): azimuth_(), length_() {
-    set_x_y(point.x_, point.y_);
+  const double length = vector.get_length();
+  if (!std::isfinite(length)) {
+    throw std::invalid_argument(fmt::format("Invalid length: {}", length));
   }
-  Vector(const std::vector<double>& initializer) {
-    if (initializer.size() != 2) {
-      throw std::out_of_range("Initializer length isn't 2 in construction of vector");
-    }
-    set_azimuth(initializer[0]);
-    set_length(initializer[1]);
+  if (length / spacing > max_samples) {
+    throw std::invalid_argument(fmt::format("Too many samples for length {} and spacing {}", length, spacing));
   }
-  Vector& operator=(const Vector&) = default;
-  Vector& operator=(Vector&&) = default;
+  const py::ssize_t count = static_cast<py::ssize_t>(std::ceil(length / spacing));
+  return line_positions(ortho_line(vector, start, get_ellipsoid(ellipsoid)), count + 1,
+      [&](const py::ssize_t i) { return i < count ? i * spacing : length; }, threads);
+}
+
+
+OutputArray cross_track_batch(
+    const DoubleArray& start_latitude, const DoubleArray& start_longitude,
+    const DoubleArray& end_latitude, const DoubleArray& end_longitude,
+    const DoubleArray& latitude, const DoubleArray& longitude,
+    const std::string& kind_name, const py::object& out, const int threads, const Ellipsoid* ellipsoid) {
+  const LineKind kind = get_line_kind(kind_name);
+  const Ellipsoid& model = get_ellipsoid(ellipsoid);
+  Broadcast<6> broadcast({&start_latitude, &start_longitude, &end_latitude, &end_longitude, &latitude, &longitude});
+  auto result = output_array(out, broadcast.shape, 2);
+  double* values = result.mutable_data();
+  run_batch(broadcast, threads, [&](const py::ssize_t i, const std::array<double, 6>& args) {
+    const Intercept intercept = line_intercept(model, kind, args[0], args[1], args[2], args[3], args[4], args[5]);
+    values[2 * i] = intercept.cross;
+    values[2 * i + 1] = intercept.along;
+  });
+  return result;
+}
+
+
+OutputArray cpa_batch(
+    const DoubleArray& latitude1, const DoubleArray& longitude1, const DoubleArray& course1, const DoubleArray& speed1,
+    const DoubleArray& latitude2, const DoubleArray& longitude2, const DoubleArray& course2, const DoubleArray& speed2,
+    const py::object& out, const int threads, const Ellipsoid* ellipsoid) {
+  const gl::Geodesic& geodesic = get_ellipsoid(ellipsoid).geodesic();
+  Broadcast<8> broadcast({&latitude1, &longitude1, &course1, &speed1, &latitude2, &longitude2, &course2, &speed2});
+  auto result = output_array(out, broadcast.shape, 2);
+  double* values = result.mutable_data();
+  run_batch(broadcast, threads, [&](const py::ssize_t i, const std::array<double, 8>& args) {
+    std::tie(values[2 * i], values[2 * i + 1]) = closest_approach(geodesic,
+        args[0], args[1], args[2], args[3], args[4], args[5], args[6], args[7]);
+  });
+  return result;
+}
+
+
+/**
+ * Get the number of value pairs in an (N, 2) array
+ */
+size_t get_pair_count(const DoubleArray& values, const char* name) {
+  if (values.ndim() != 2 || values.shape(1) != 2) {
+    throw std::invalid_argument(fmt::format(
+        "Can't construct {} from array of shape ({})", name, fmt::join(get_shape(values), ", ")));
+  }
+  return values.shape(0);
+}
 
-  double get_azimuth() const {
-    return azimuth_;
+
+/**
+ * Get the values of a pair from a buffer, e.g. a numpy array, of length 2
+ */
+std::pair<double, double> get_pair(const DoubleArray& values, const char* name) {
+  if (values.size() != 2) {
+    throw std::out_of_range(fmt::format("Initializer length isn't 2 in construction of {}", name));
   }
+  return {values.data()[0], values.data()[1]};
+}
+
 
-  double get_length() const {
-    return length_;
+/**
+ * Construct VectorArray from arrays of azimuths and lengths
+ */
+VectorArray vector_array(const DoubleArray& azimuths, const DoubleArray& lengths) {
+  if (lengths.size() != azimuths.size()) {
+    throw std::invalid_argument(fmt::format(
+        "Can't construct VectorArray from {} azimuths and {} lengths", azimuths.size(), lengths.size()));
   }
+  return VectorArray(azimuths.data(), lengths.data(), azimuths.size());
+}
+
 
-  Vector& set_azimuth(const double azimuth) {
-    azimuth_ = angle_mod(azimuth);
-    return *this;
+/**
+ * Construct VectorArray from (N, 2) array of azimuths and lengths
+ */
+VectorArray vector_array(const DoubleArray& values) {
+  return VectorArray(values.data(), get_pair_count(values, "VectorArray"));
+}
+
+
+/**
+ * Construct PositionArray from arrays of latitudes and longitudes
+ */
+PositionArray position_array(const DoubleArray& latitudes, const DoubleArray& longitudes) {
+  if (longitudes.size() != latitudes.size()) {
+    throw std::invalid_argument(fmt::format(
+        "Can't construct PositionArray from {} latitudes and {} longitudes", latitudes.size(), longitudes.size()));
   }
+  return PositionArray(latitudes.data(), longitudes.data(), latitudes.size());
+}
+
+
+/**
+ * Construct PositionArray from (N, 2) array of latitudes and longitudes
+ */
+PositionArray position_array(const DoubleArray& values) {
+  return PositionArray(values.data(), get_pair_count(values, "PositionArray"));
+}
+
+
+template <typename Kernel>
+OutputArray approximate_distance_batch(
+    const DoubleArray& latitude1, const DoubleArray& longitude1,
+    const DoubleArray& latitude2, const DoubleArray& longitude2,
+    const py::object& out, const int threads, const Ellipsoid* ellipsoid, Kernel kernel) {
+  const ApproximateDistance approximate(get_ellipsoid(ellipsoid).geodesic());
+  Broadcast<4> broadcast({&latitude1, &longitude1, &latitude2, &longitude2});
+  auto result = output_array(out, broadcast.shape);
+  double* values = result.mutable_data();
+  run_batch(broadcast, threads, [&](const py::ssize_t i, const std::array<double, 4>& args) {
+    values[i] = kernel(approximate, args);
+  });
+  return result;
+}
+
+
+OutputArray haversine_distance(
+    const DoubleArray& latitude1, const DoubleArray& longitude1,
+    const DoubleArray& latitude2, const DoubleArray& longitude2,
+    const py::object& out, const int threads, const Ellipsoid* ellipsoid) {
+  return approximate_distance_batch(latitude1, longitude1, latitude2, longitude2, out, threads, ellipsoid,
+      [](const ApproximateDistance& approximate, const std::array<double, 4>& args) {
+        return approximate.haversine(args[0], args[1], args[2], args[3]);
+      });
+}
 
-  Vector& set_length(const double length) {
-    // Prefer a positive length
-    if (length < 0) {
-      set_azimuth(azimuth_ + 180.0);
-      length_ = -length;
+
+OutputArray equirectangular_distance(
+    const DoubleArray& latitude1, const DoubleArray& longitude1,
+    const DoubleArray& latitude2, const DoubleArray& longitude2,
+    const py::object& out, const int threads, const Ellipsoid* ellipsoid) {
+  return approximate_distance_batch(latitude1, longitude1, latitude2, longitude2, out, threads, ellipsoid,
+      [](const ApproximateDistance& approximate, const std::array<double, 4>& args) {
+        return approximate.equirectangular(args[0], args[1], args[2], args[3]);
+      });
+}
+
+
+OutputArray andoyer_lambert_distance(
+    const DoubleArray& latitude1, const DoubleArray& longitude1,
+    const DoubleArray& latitude2, const DoubleArray& longitude2,
+    const py::object& out, const int threads, const Ellipsoid* ellipsoid) {
+  return approximate_distance_batch(latitude1, longitude1, latitude2, longitude2, out, threads, ellipsoid,
+      [](const ApproximateDistance& approximate, const std::array<double, 4>& args) {
+        return approximate.andoyer_lambert(args[0], args[1], args[2], args[3]);
+      });
+}
+
+
+py::array_t<bool> geodesic_within(
+    const DoubleArray& latitude1, const DoubleArray& longitude1,
+    const DoubleArray& latitude2, const DoubleArray& longitude2,
+    const DoubleArray& radius, const int threads, const Ellipsoid* ellipsoid) {
+  const ApproximateDistance approximate(get_ellipsoid(ellipsoid).geodesic());
+  Broadcast<5> broadcast({&latitude1, &longitude1, &latitude2, &longitude2, &radius});
+  py::array_t<bool> result(broadcast.shape);
+  bool* values = result.mutable_data();
+  run_batch(broadcast, threads, [&](const py::ssize_t i, const std::array<double, 5>& args) {
+    values[i] = approximate.within(args[0], args[1], args[2], args[3], args[4]);
+  });
+  return result;
+}
+
+
+/**
+ * Latitudes and longitudes of either a PositionArray or an (N, 2) array
+ */
+struct Coordinates {
+  Coordinates(const py::object& positions): object_(positions) {
+    if (py::isinstance<PositionArray>(positions)) {
+      const auto& array = positions.cast<const PositionArray&>();
+      latitudes_ = array.latitudes();
+      longitudes_ = array.longitudes();
+      stride_ = 1;
+      size_ = array.size();
     }
     else {
-      length_ = length;
+      values_ = positions.cast<DoubleArray>();
+      size_ = get_pair_count(values_, "Coordinates");
+      latitudes_ = values_.data();
+      longitudes_ = latitudes_ + 1;
+      stride_ = 2;
     }
-    return *this;
   }
 
-  double get_x() const {
-    return cos(d2r * azimuth_) * length_;
+  py::ssize_t size() const {
+    return size_;
   }
 
-  double get_y() const {
-    return sin(d2r * azimuth_) * length_;
+  double latitude(const py::ssize_t i) const {
+    return latitudes_[i * stride_];
   }
 
-  Vector& set_x(const double x) {
-    set_x_y(x, get_y());
-    return *this;
+  double longitude(const py::ssize_t i) const {
+    return longitudes_[i * stride_];
   }
 
-  Vector& set_y(const double y) {
-    set_x_y(get_x(), y);
-    return *this;
-  }
+private:
+  py::object object_;
+  DoubleArray values_;
+  const double* latitudes_ = nullptr;
+  const double* longitudes_ = nullptr;
+  py::ssize_t stride_ = 0;
+  py::ssize_t size_ = 0;
+};
 
-  Vector& set_x_y(const double x, const double y) {
-    azimuth_ = r2d * atan2(y, x);
-    azimuth_ = azimuth_ < 0 ? azimuth_ + 360.0 : azimuth_;
-    length_ = hypot(x, y);
-    return *this;
-  }
 
-  bool operator==(const Vector& vector) const {
-    return floats_equal(azimuth_, vector.azimuth_) && floats_equal(length_, vector.length_);
+/**
+ * Get matrix of distances between all positions in "positions1" and all
+ * positions in "positions2". Only distances are requested from GeographicLib.
+ * When "positions2" is None, the symmetric matrix of distances between
+ * "positions1" is returned.
+ */
+OutputArray distance_matrix(const py::object& positions1, const py::object& positions2,
+    const std::string& metric_name, const py::object& out, const int threads, const Ellipsoid* ellipsoid) {
+  const gl::Geodesic& geodesic = get_ellipsoid(ellipsoid).geodesic();
+  const gl::Rhumb& rhumb = get_ellipsoid(ellipsoid).rhumb();
+  const Metric metric = get_metric(metric_name);
+  const bool symmetric = positions2.is_none();
+  const Coordinates a(positions1);
+  const Coordinates b(symmetric ? positions1 : positions2);
+  auto result = output_array(out, {a.size()}, b.size());
+  GEOFUN_PROBE(distance_matrix, a.size() * b.size());
+  double* values = result.mutable_data();
+  py::gil_scoped_release release;
+  switch (metric) {
+    case Metric::geodesic:
+      fill_matrix(values, a.size(), b.size(), symmetric, threads, [&](const py::ssize_t i, const py::ssize_t j) {
+        double distance;
+        geodesic.Inverse(a.latitude(i), a.longitude(i), b.latitude(j), b.longitude(j), distance);
+        return distance;
+      });
+      break;
+    case Metric::rhumb:
+      fill_matrix(values, a.size(), b.size(), symmetric, threads, [&](const py::ssize_t i, const py::ssize_t j) {
+        double distance;
+        double azimuth;
+        rhumb_inverse_kernel<output_distance>(rhumb, a.latitude(i), a.longitude(i), b.latitude(j), b.longitude(j),
+            distance, azimuth);
+        return distance;
+      });
+      break;
+    case Metric::haversine: {
+      const ApproximateDistance approximate(geodesic);
+      fill_matrix(values, a.size(), b.size(), symmetric, threads, [&](const py::ssize_t i, const py::ssize_t j) {
+        return approximate.haversine(a.latitude(i), a.longitude(i), b.latitude(j), b.longitude(j));
+      });
+      break;
+    }
   }
+  return result;
+}
+
 
-  bool operator==(const Point& point) const {
-    return floats_equal(get_x(), point.get_x()) && floats_equal(get_y(), point.get_y());
+py::tuple index_nearest(const PositionIndex& index, const py::object& positions, const py::ssize_t count,
+    const int threads) {
+  if (count < 1) {
+    throw std::invalid_argument(fmt::format("Invalid neighbour count: {}", count));
+  }
+  const Coordinates coordinates(positions);
+  const py::ssize_t size = coordinates.size();
+  py::array_t<int64_t> indices({size, count});
+  OutputArray distances({size, count});
+  int64_t* index_values = indices.mutable_data();
+  double* distance_values = distances.mutable_data();
+  {
+    py::gil_scoped_release release;
+    parallel_for(size, threads, [&](const py::ssize_t begin, const py::ssize_t end) {
+      for (py::ssize_t i = begin; i < end; ++i) {
+        index.nearest(coordinates.latitude(i), coordinates.longitude(i), count,
+            index_values + i * count, distance_values + i * count);
+      }
+    }, 16);
   }
+  return py::make_tuple(indices, distances);
+}
 
-  bool operator==(const std::vector<double>& other) const {
-    if (other.size() != 2) {
-      throw std::out_of_range(fmt::format("Can't compare Vector to container of size {}", other.size()));
+
+py::tuple index_within(const PositionIndex& index, const py::object& positions, const DoubleArray& radius,
+    const int threads) {
+  const Coordinates coordinates(positions);
+  const py::ssize_t size = coordinates.size();
+  if (radius.size() != 1 && radius.size() != size) {
+    throw std::invalid_argument(fmt::format("Expected 1 or {} radii, got {}", size, radius.size()));
+  }
+  const double* radii = radius.data();
+  const py::ssize_t radius_step = radius.size() == 1 ? 0 : 1;
+  std::vector<std::vector<std::pair<double, int64_t>>> results(size);
+  {
+    py::gil_scoped_release release;
+    parallel_for(size, threads, [&](const py::ssize_t begin, const py::ssize_t end) {
+      for (py::ssize_t i = begin; i < end; ++i) {
+        index.within(coordinates.latitude(i), coordinates.longitude(i), radii[i * radius_step], results[i]);
+      }
+    }, 16);
+  }
+  py::array_t<int64_t> offsets(size + 1);
+  int64_t* offset = offsets.mutable_data();
+  offset[0] = 0;
+  for (py::ssize_t i = 0; i < size; ++i) {
+    offset[i + 1] = offset[i] + static_cast<int64_t>(results[i].size());
+  }
+  py::array_t<int64_t> indices(offset[size]);
+  OutputArray distances(offset[size]);
+  int64_t* index_values = indices.mutable_data();
+  double* distance_values = distances.mutable_data();
+  for (py::ssize_t i = 0; i < size; ++i) {
+    for (const auto& [distance, j]: results[i]) {
+      *distance_values++ = distance;
+      *index_values++ = j;
     }
-    return floats_equal(get_azimuth(), other[0]) && floats_equal(get_length(), other[1]);
   }
+  return py::make_tuple(offsets, indices, distances);
+}
 
-  Vector& operator+=(const Vector& vector) {
-    set_x_y(get_x() + vector.get_x(), get_y() + vector.get_y());
-    return *this;
-  }
 
-  Vector& operator-=(const Vector& vector) {
-    set_x_y(get_x() - vector.get_x(), get_y() - vector.get_y());
-    return *this;
-  }
+OutputArray copy_array(const double* values, const py::ssize_t size) {
+  OutputArray result(size);
+  std::copy(values, values + size, result.mutable_data());
+  return result;
+}
 
-  Vector& operator+=(const double angle) {
-    return set_azimuth(azimuth_ + angle);
-  }
 
-  Vector& operator-=(const double angle) {
-    return set_azimuth(azimuth_ - angle);
+/**
+ * Get the next chunk of a track file as dictionary of arrays
+ */
+py::dict read_chunk(TrackReader& reader) {
+  py::ssize_t count;
+  {
+    py::gil_scoped_release release;
+    count = reader.read();
   }
-
-  Vector& operator*=(const double multiplier) {
-    return set_length(length_ * multiplier);
+  if (count == 0) {
+    throw py::stop_iteration();
   }
-
-  Vector& operator/=(const double divider) {
-    return set_length(length_ / divider);
+  py::dict chunk;
+  chunk["times"] = copy_array(reader.times(), count);
+  chunk["latitudes"] = copy_array(reader.latitudes(), count);
+  chunk["longitudes"] = copy_array(reader.longitudes(), count);
+  if (reader.has_legs()) {
+    chunk["distances"] = copy_array(reader.distances(), count);
+    chunk["azimuths"] = copy_array(reader.azimuths(), count);
   }
+  return chunk;
+}
 
-  Vector operator+(const Vector& vector) const {
-    Vector result(*this);
-    result += vector;
-    return result;
-  }
 
-  Vector operator-(const Vector& vector) const {
-    Vector result(*this);
-    result -= vector;
-    return result;
-  }
+using IdArray = py::array_t<int64_t, py::array::c_style | py::array::forcecast>;
 
-  Vector operator+(const double angle) const {
-    Vector result(*this);
-    result += angle;
-    return result;
-  }
 
-  Vector operator-(const double angle) const {
-    Vector result(*this);
-    result -= angle;
-    return result;
+/**
+ * Get track ids for size records from an array, or an empty array when ids is None
+ */
+IdArray get_ids(const py::object& ids, const py::ssize_t size) {
+  if (ids.is_none()) {
+    return IdArray(0);
   }
-
-  Vector operator*(const double multiplier) const {
-    Vector result(*this);
-    result *= multiplier;
-    return result;
+  auto result = ids.cast<IdArray>();
+  if (result.ndim() != 1 || result.size() != size) {
+    throw std::invalid_argument(fmt::format("Ids should be a 1D array of size {}", size));
   }
+  return result;
+}
 
-  Vector operator/(const double divider) const {
-    Vector result(*this);
-    result /= divider;
-    return result;
-  }
 
-  Vector operator-() const {
-    return Vector(azimuth_ + 180.0, length_);
-  }
+/**
+ * Get metrics of tracks: per record the leg from the previous record, speed,
+ * course over ground, cumulative distance and turn rate. Records of a track
+ * are consecutive and in order of time. When ids are given, each change of
+ * id starts a new track.
+ */
+py::dict track_metrics(const DoubleArray& times, const DoubleArray& latitudes, const DoubleArray& longitudes,
+    const py::object& ids, const std::string& metric_name, const int threads, const Ellipsoid* ellipsoid) {
+  const Metric metric = get_leg_metric(metric_name);
+  const py::ssize_t size = times.size();
+  if (times.ndim() != 1 || latitudes.ndim() != 1 || longitudes.ndim() != 1
+      || latitudes.size() != size || longitudes.size() != size) {
+    throw std::invalid_argument("Times, latitudes and longitudes should be 1D arrays of equal size");
+  }
+  const IdArray id_array = get_ids(ids, size);
+  const int64_t* id = ids.is_none() ? nullptr : id_array.data();
+  OutputArray distances(size);
+  OutputArray azimuths(size);
+  OutputArray final_azimuths(size);
+  OutputArray speeds(size);
+  OutputArray courses(size);
+  OutputArray cumulative_distances(size);
+  OutputArray turn_rates(size);
+  const TrackMetrics metrics{distances.mutable_data(), azimuths.mutable_data(), final_azimuths.mutable_data(),
+      speeds.mutable_data(), courses.mutable_data(), cumulative_distances.mutable_data(), turn_rates.mutable_data()};
+  {
+    py::gil_scoped_release release;
+    compute_track_metrics(times.data(), latitudes.data(), longitudes.data(), size, id, metric, threads,
+        get_ellipsoid(ellipsoid), metrics);
+  }
+  py::dict result;
+  result["distances"] = distances;
+  result["azimuths"] = azimuths;
+  result["final_azimuths"] = final_azimuths;
+  result["speeds"] = speeds;
+  result["courses"] = courses;
+  result["cumulative_distances"] = cumulative_distances;
+  result["turn_rates"] = turn_rates;
+  return result;
+}
 
-  Vector norm() const {
-    return Vector(azimuth_, 1.0);
-  }
 
-  double dot(const Vector& vector) const {
-    return length_ * vector.length_ * cos(d2r * (vector.azimuth_ - azimuth_));
-  }
+/**
+ * Simplify tracks, keeping every record within tolerance meters of the
+ * simplified track. Returns the indices of the kept records.
+ */
+py::array_t<int64_t> simplify(const DoubleArray& latitudes, const DoubleArray& longitudes, const double tolerance,
+    const py::object& ids, const int threads, const Ellipsoid* ellipsoid) {
+  const py::ssize_t size = latitudes.size();
+  if (latitudes.ndim() != 1 || longitudes.ndim() != 1 || longitudes.size() != size) {
+    throw std::invalid_argument("Latitudes and longitudes should be 1D arrays of equal size");
+  }
+  const IdArray id_array = get_ids(ids, size);
+  const int64_t* id = ids.is_none() ? nullptr : id_array.data();
+  std::vector<int64_t> kept;
+  {
+    py::gil_scoped_release release;
+    kept = simplify_tracks(latitudes.data(), longitudes.data(), size, tolerance, id, threads,
+        get_ellipsoid(ellipsoid));
+  }
+  return py::array_t<int64_t>(kept.size(), kept.data());
+}
 
-  double cross(const Vector& vector) const {
-    return length_ * vector.length_ * sin(d2r * (vector.azimuth_ - azimuth_));
-  }
 
-  Point point() const {
-    return Point(get_x(), get_y());
+/**
+ * Test PositionArray or (N, 2) array of positions for being inside polygon
+ */
+py::array_t<bool> polygon_contains(const Polygon& polygon, const py::object& positions, const std::string& kind,
+    const int threads) {
+  const LineKind line_kind = get_line_kind(kind);
+  const Coordinates coordinates(positions);
+  const py::ssize_t size = coordinates.size();
+  py::array_t<bool> result(size);
+  bool* inside = result.mutable_data();
+  {
+    py::gil_scoped_release release;
+    parallel_for(size, threads, [&](const py::ssize_t begin, const py::ssize_t end) {
+      for (py::ssize_t i = begin; i < end; ++i) {
+        inside[i] = polygon.contains(coordinates.latitude(i), coordinates.longitude(i), line_kind);
+      }
+    });
   }
+  return result;
+}
 
-  double get_item(int i) const {
-    i = i < 0 ? i + 2 : i;
-    switch(i) {
-      case 0: return get_azimuth();
-      case 1: return get_length();
-      default: throw std::out_of_range(fmt::format("Index {} is out of range for Vector", i));
-    }
-  }
 
-  Vector& set_item(int i, const double value) {
-    i = i < 0 ? i + 2 : i;
-    switch(i) {
-      case 0: return set_azimuth(value);
-      case 1: return set_length(value);
-      default: throw std::out_of_range(fmt::format("Index {} is out of range for Vector", i));
-    }
+/**
+ * Project PositionArray or (N, 2) array of positions to (N, 2) array of x, y
+ */
+OutputArray project_forward(const Projector& projector, const py::object& positions, const py::object& out,
+    const int threads) {
+  const Coordinates coordinates(positions);
+  const py::ssize_t size = coordinates.size();
+  OutputArray result = output_array(out, {size}, 2);
+  double* values = result.mutable_data();
+  {
+    py::gil_scoped_release release;
+    parallel_for(size, threads, [&](const py::ssize_t begin, const py::ssize_t end) {
+      for (py::ssize_t i = begin; i < end; ++i) {
+        projector.forward(coordinates.latitude(i), coordinates.longitude(i), values[2 * i], values[2 * i + 1]);
+      }
+    });
   }
+  return result;
+}
 
-  constexpr int get_len() const {
-    return 2;
-  }
 
-  double operator[](const int i) {
-    return get_item(i);
+/**
+ * Project (N, 2) array of x, y back to (N, 2) array of latitudes and longitudes
+ */
+OutputArray project_reverse(const Projector& projector, const DoubleArray& points, const py::object& out,
+    const int threads) {
+  const py::ssize_t size = get_pair_count(points, "Points");
+  const double* point = points.data();
+  OutputArray result = output_array(out, {size}, 2);
+  double* values = result.mutable_data();
+  {
+    py::gil_scoped_release release;
+    parallel_for(size, threads, [&](const py::ssize_t begin, const py::ssize_t end) {
+      for (py::ssize_t i = begin; i < end; ++i) {
+        projector.reverse(point[2 * i], point[2 * i + 1], values[2 * i], values[2 * i + 1]);
+      }
+    });
   }
+  return result;
+}
+
 
-  std::string get_string() const {
-    return fmt::format("{:.3f}, {:.3f}", azimuth_, length_);
+/**
+ * Get C contiguous 1D array of fixed width byte strings from an array or
+ * sequence of str or bytes
+ */
+py::array get_byte_strings(const py::object& values) {
+  auto result = get_numpy().attr("ascontiguousarray")(values, "dtype"_a = "S").cast<py::array>();
+  if (result.ndim() != 1) {
+    throw std::invalid_argument("Codes should be a 1D array or sequence of strings");
   }
+  return result;
+}
+
 
-  std::string get_representation() const {
-    double i;
-    double x_frac = modf(azimuth_, &i);
-    double y_frac = modf(length_, &i);
-    std::string format = x_frac == 0.0 ? "Vector({:.1f}" : "Vector({:.15g}";
-    format += y_frac == 0.0 ? ", {:.1f})" : ", {:.15g})";
-    return fmt::format(fmt::runtime(format), azimuth_, length_);
+/**
+ * Encode positions to fixed width byte strings with encode(latitude,
+ * longitude, code). Positions that can't be encoded give empty strings.
+ */
+template <typename Encode>
+py::array encode_positions(const DoubleArray& latitudes, const DoubleArray& longitudes, const py::ssize_t width,
+    const int threads, Encode encode) {
+  const py::ssize_t size = latitudes.size();
+  if (latitudes.ndim() != 1 || longitudes.ndim() != 1 || longitudes.size() != size) {
+    throw std::invalid_argument("Latitudes and longitudes should be 1D arrays of equal size");
+  }
+  const double* latitude = latitudes.data();
+  const double* longitude = longitudes.data();
+  py::array result(py::dtype(fmt::format("S{}", width)), {size});
+  char* codes = static_cast<char*>(result.mutable_data());
+  {
+    py::gil_scoped_release release;
+    parallel_for(size, threads, [&](const py::ssize_t begin, const py::ssize_t end) {
+      std::string code;
+      for (py::ssize_t i = begin; i < end; ++i) {
+        char* destination = codes + i * width;
+        std::memset(destination, 0, width);
+        if (encode(latitude[i], longitude[i], code)) {
+          std::memcpy(destination, code.data(), std::min<size_t>(code.size(), width));
+        }
+      }
+    });
   }
+  return result;
+}
 
-  std::vector<Position> split_ortho(const Position& start, const int number_of_segments) const;
-  std::vector<Position> split_loxo(const Position& start, const int number_of_segments) const;
-private:
-  friend struct Position;
-  double azimuth_;
-  double length_;
-};
 
-bool operator==(const Point& point, const Vector& vector) {
-  return vector.operator==(point);
+/**
+ * Decode byte strings to (N, 2) array of latitudes and longitudes with
+ * decode(code, latitude, longitude). Codes that can't be decoded give NaN.
+ */
+template <typename Decode>
+OutputArray decode_positions(const py::object& values, const int threads, Decode decode) {
+  const py::array strings = get_byte_strings(values);
+  const py::ssize_t size = strings.size();
+  const py::ssize_t width = strings.itemsize();
+  const char* codes = static_cast<const char*>(strings.data());
+  OutputArray result({size, py::ssize_t(2)});
+  double* values_out = result.mutable_data();
+  {
+    py::gil_scoped_release release;
+    parallel_for(size, threads, [&](const py::ssize_t begin, const py::ssize_t end) {
+      const double nan = std::numeric_limits<double>::quiet_NaN();
+      std::string code;
+      for (py::ssize_t i = begin; i < end; ++i) {
+        const char* source = codes + i * width;
+        code.assign(source, strnlen(source, width));
+        double& latitude = values_out[2 * i];
+        double& longitude = values_out[2 * i + 1];
+        if (!decode(code, latitude, longitude)) {
+          latitude = longitude = nan;
+        }
+      }
+    });
+  }
+  return result;
 }
 
-Vector operator*(const double multiplier, const Vector& vector) {
-  return vector.operator*(multiplier);
+
+/**
+ * Get UTM or UPS zones, hemispheres and (N, 2) array of eastings and
+ * northings of positions. Zone 0 is UPS, positions that can't be converted
+ * get zone gl::UTMUPS::INVALID and NaN coordinates.
+ */
+py::tuple utm_encode(const DoubleArray& latitudes, const DoubleArray& longitudes, const int threads) {
+  const py::ssize_t size = latitudes.size();
+  if (latitudes.ndim() != 1 || longitudes.ndim() != 1 || longitudes.size() != size) {
+    throw std::invalid_argument("Latitudes and longitudes should be 1D arrays of equal size");
+  }
+  const double* latitude = latitudes.data();
+  const double* longitude = longitudes.data();
+  py::array_t<int32_t> zones(size);
+  py::array_t<bool> north(size);
+  OutputArray coordinates({size, py::ssize_t(2)});
+  int32_t* zone = zones.mutable_data();
+  bool* northp = north.mutable_data();
+  double* coordinate = coordinates.mutable_data();
+  {
+    py::gil_scoped_release release;
+    parallel_for(size, threads, [&](const py::ssize_t begin, const py::ssize_t end) {
+      for (py::ssize_t i = begin; i < end; ++i) {
+        int value;
+        utm_forward(latitude[i], longitude[i], value, northp[i], coordinate[2 * i], coordinate[2 * i + 1]);
+        zone[i] = value;
+      }
+    });
+  }
+  return py::make_tuple(zones, north, coordinates);
 }
 
-Vector operator+(const double angle, const Vector& vector) {
-  return vector.operator+(angle);
+
+/**
+ * Get (N, 2) array of latitudes and longitudes of UTM or UPS coordinates.
+ * Invalid coordinates give NaN.
+ */
+OutputArray utm_decode(const py::array_t<int32_t, py::array::forcecast>& zones,
+    const py::array_t<bool, py::array::forcecast>& north, const DoubleArray& coordinates, const int threads) {
+  const py::ssize_t size = get_pair_count(coordinates, "UTM coordinates");
+  if (zones.ndim() != 1 || north.ndim() != 1 || zones.size() != size || north.size() != size) {
+    throw std::invalid_argument(fmt::format("Zones and hemispheres should be 1D arrays of size {}", size));
+  }
+  const int32_t* zone = zones.data();
+  const bool* northp = north.data();
+  const double* coordinate = coordinates.data();
+  OutputArray result({size, py::ssize_t(2)});
+  double* values = result.mutable_data();
+  {
+    py::gil_scoped_release release;
+    parallel_for(size, threads, [&](const py::ssize_t begin, const py::ssize_t end) {
+      for (py::ssize_t i = begin; i < end; ++i) {
+        utm_reverse(zone[i], northp[i], coordinate[2 * i], coordinate[2 * i + 1], values[2 * i], values[2 * i + 1]);
+      }
+    });
+  }
+  return result;
 }
 
-Vector operator-(const double angle, const Vector& vector) {
-  return -vector.operator+(angle);
+
+/**
+ * Get MGRS references with precision digits per coordinate, 5 being 1 m
+ */
+py::array mgrs_encode(const DoubleArray& latitudes, const DoubleArray& longitudes, const int precision,
+    const int threads) {
+  check_mgrs_precision(precision);
+  // Grid zone and 100 km square letters followed by the digits
+  return encode_positions(latitudes, longitudes, 5 + 2 * precision, threads,
+      [precision](const double latitude, const double longitude, std::string& code) {
+        return mgrs_forward(latitude, longitude, precision, code);
+      });
 }
 
 
-Point& Point::operator+=(const Vector& vector) {
-  x_ += vector.get_x();
-  y_ += vector.get_y();
-  return *this;
+/**
+ * Get (N, 2) array of latitudes and longitudes of the centers of MGRS squares
+ */
+OutputArray mgrs_decode(const py::object& codes, const int threads) {
+  return decode_positions(codes, threads, &mgrs_reverse);
 }
 
-Point& Point::operator-=(const Vector& vector) {
-  x_ -= vector.get_x();
-  y_ -= vector.get_y();
-  return *this;
+
+py::array geohash_encode(const DoubleArray& latitudes, const DoubleArray& longitudes, const int length,
+    const int threads) {
+  check_geohash_length(length);
+  return encode_positions(latitudes, longitudes, length, threads,
+      [length](const double latitude, const double longitude, std::string& code) {
+        return geohash_forward(latitude, longitude, length, code);
+      });
 }
 
-Point operator+(const Point& point, const Vector& vector) {
-  Point result{point};
-  result += vector;
-  return result;
+
+/**
+ * Get (N, 2) array of latitudes and longitudes of the centers of geohash cells
+ */
+OutputArray geohash_decode(const py::object& codes, const int threads) {
+  return decode_positions(codes, threads, &geohash_reverse);
 }
 
-Point operator-(const Point& point, const Vector& vector) {
-  Point result{point};
-  result -= vector;
-  return result;
+
+/**
+ * Find the intersections of the legs of a route with (M, 4) array of
+ * segments from latitude, longitude to latitude, longitude. Pairs whose
+ * bounds don't overlap are rejected before solving. Returns the leg and
+ * segment indices and positions of the intersections, ordered by leg.
+ */
+py::tuple route_intersections(const py::object& route, const DoubleArray& segments, const std::string& kind,
+    const int threads, const Ellipsoid* ellipsoid) {
+  const Coordinates coordinates(route);
+  if (segments.ndim() != 2 || segments.shape(1) != 4) {
+    throw std::invalid_argument(fmt::format(
+        "Segments should have shape (M, 4), got ({})", fmt::join(get_shape(segments), ", ")));
+  }
+  const SegmentIntersector intersector(get_ellipsoid(ellipsoid), get_line_kind(kind));
+  const py::ssize_t legs = std::max<py::ssize_t>(coordinates.size() - 1, 0);
+  const py::ssize_t count = segments.shape(0);
+  const double* segment = segments.data();
+  struct Crossing {
+    int64_t leg;
+    int64_t segment;
+    double latitude;
+    double longitude;
+  };
+  std::vector<std::vector<Crossing>> crossings(count);
+  {
+    py::gil_scoped_release release;
+    std::vector<Box> leg_boxes(legs);
+    parallel_for(legs, threads, [&](const py::ssize_t begin, const py::ssize_t end) {
+      for (py::ssize_t i = begin; i < end; ++i) {
+        leg_boxes[i] = intersector.get_box(coordinates.latitude(i), coordinates.longitude(i),
+            coordinates.latitude(i + 1), coordinates.longitude(i + 1));
+      }
+    }, 64);
+    parallel_for(count, threads, [&](const py::ssize_t begin, const py::ssize_t end) {
+      for (py::ssize_t j = begin; j < end; ++j) {
+        const double* values = segment + 4 * j;
+        const Box box = intersector.get_box(values[0], values[1], values[2], values[3]);
+        for (py::ssize_t i = 0; i < legs; ++i) {
+          double latitude;
+          double longitude;
+          if (box.overlaps(leg_boxes[i]) && intersector.intersection(
+              coordinates.latitude(i), coordinates.longitude(i),
+              coordinates.latitude(i + 1), coordinates.longitude(i + 1),
+              values[0], values[1], values[2], values[3], latitude, longitude)) {
+            crossings[j].push_back({i, j, latitude, longitude});
+          }
+        }
+      }
+    }, 64);
+  }
+  std::vector<Crossing> sorted;
+  for (const auto& found: crossings) {
+    sorted.insert(sorted.end(), found.begin(), found.end());
+  }
+  std::stable_sort(sorted.begin(), sorted.end(), [](const Crossing& crossing1, const Crossing& crossing2) {
+    return crossing1.leg < crossing2.leg;
+  });
+  const py::ssize_t size = sorted.size();
+  py::array_t<int64_t> leg_indices(size);
+  py::array_t<int64_t> segment_indices(size);
+  OutputArray positions({size, py::ssize_t(2)});
+  int64_t* leg_index = leg_indices.mutable_data();
+  int64_t* segment_index = segment_indices.mutable_data();
+  double* position = positions.mutable_data();
+  for (py::ssize_t k = 0; k < size; ++k) {
+    leg_index[k] = sorted[k].leg;
+    segment_index[k] = sorted[k].segment;
+    position[2 * k] = sorted[k].latitude;
+    position[2 * k + 1] = sorted[k].longitude;
+  }
+  return py::make_tuple(leg_indices, segment_indices, positions);
 }
 
-struct Position {
-  Position() = default;
-  Position(const Position&) = default;
-  Position(Position&&) = default;
 
-  Position(const double latitude, const double longitude): latitude_(), longitude_() {
-    set_latitude(latitude);
-    set_longitude(longitude);
-  }
+using FloatArray = py::array_t<float, py::array::c_style>;
 
-  Position(const int latitude, const int longitude): latitude_(), longitude_() {
-    set_latitude_seconds(latitude);
-    set_longitude_seconds(longitude);
-  }
 
-  Position(const std::vector<double>& initializer) {
-    if (initializer.size() != 2) {
-      throw std::out_of_range("Initializer length isn't 2 in construction of Position");
-    }
-    set_latitude(initializer[0]);
-    set_longitude(initializer[1]);
-  }
-
-  Position(const std::string& latitude, const std::string& longitude): latitude_(), longitude_() {
-    std::vector<double> values;
-    bool is_integral = scan_floats(values, latitude);
-    is_integral &= scan_floats(values, longitude);
-    int val_count = static_cast<int>(values.size());
-    int i_count = val_count / 2;
-    if ((val_count == 0) || (val_count % 2) || (i_count > 3)) {
-      throw std::invalid_argument(fmt::format("Invalid argument count: {} for Position", val_count));
-    }
-    size_t pos_N = latitude.find('N');
-    size_t pos_S = latitude.find('S');
-    bool is_south = pos_S != std::string::npos;
-    bool single = longitude == "";
-    size_t pos_E = single ? latitude.find('E') : longitude.find('E');
-    size_t pos_W = single ? latitude.find('W') : longitude.find('W');
-    bool is_west = pos_W != std::string::npos;
-    size_t pos_la = std::min(pos_N, pos_S);
-    size_t pos_lo = std::min(pos_E, pos_W);
-    bool reversed = single ? pos_lo < pos_la : false;
-
-    int offset = reversed ? i_count : 0;
-    double value = values[offset];
-    double lat = is_south ? -value : value;
-    double mult = std::signbit(lat) ? (-1.0 / 60.0) : (1.0 / 60.0);
-    int i = 1;
-    while (i < i_count) {
-      value = values[offset + i++];
-      lat += value * mult;
-      mult /= 60.0;
-    }
+/**
+ * Tell whether angles are a float32 array, which is then reduced in single
+ * precision
+ */
+bool is_single(const py::object& angles) {
+  return py::isinstance<py::array_t<float>>(angles);
+}
 
-    offset = reversed ? 0 : i_count;
-    value = values[offset];
-    double lon = is_west ? -value : value;
-    mult = std::signbit(lon) ? (-1.0 / 60.0) : (1.0 / 60.0);
-    i = 1;
-    while (i < i_count) {
-      value = values[offset + i++];
-      lon += value * mult;
-      mult /= 60.0;
-    }
 
-    if (is_integral) {
-      set_latitude_seconds(static_cast<int>(lat));
-      set_longitude_seconds(static_cast<int>(lon));
-    }
-    else {
-      set_latitude(lat);
-      set_longitude(lon);
-    }
-  }
+/**
+ * Tell whether angles is a python number, which is reduced without numpy
+ */
+bool is_number(const py::object& angles) {
+  return py::isinstance<py::float_>(angles) || py::isinstance<py::int_>(angles);
+}
 
-  Position& operator=(const Position&) = default;
-  Position& operator=(Position&&) = default;
 
-  double get_latitude() const {
-    return latitude_;
+/**
+ * Get angles as C contiguous array of T that the caller owns, converting
+ * once and only copying arrays that need no conversion
+ */
+template <typename T>
+py::array owned_angles(const py::object& angles) {
+  auto array = py::array_t<T, py::array::c_style | py::array::forcecast>::ensure(angles);
+  if (!array) {
+    throw py::error_already_set();
   }
-
-  double get_longitude() const {
-    return longitude_;
+  if (!array.is(angles) && array.owndata()) {
+    return array;
   }
+  py::array_t<T, py::array::c_style> copy(get_shape(array));
+  std::copy(array.data(), array.data() + array.size(), copy.mutable_data());
+  return copy;
+}
 
-  Position& set_latitude(const double latitude) {
-    latitude_ = angle_mod_signed(latitude);
-    latitude_ = latitude_ > 90.0 ? 180.0 - latitude_ : latitude_ < -90.0 ? -180.0 - latitude_ : latitude_;
-    return *this;
-  }
 
-  Position& set_latitude_seconds(const int latitude) {
-    return set_latitude(latitude / 3600.0);
+/**
+ * Check that out is a writeable C contiguous array of float32 or float64
+ */
+py::array angle_out(const py::object& out) {
+  if (!py::isinstance<OutputArray>(out) && !py::isinstance<FloatArray>(out)) {
+    throw std::invalid_argument("Output array should be a C contiguous array of float32 or float64");
   }
-
-  Position& set_longitude(const double longitude) {
-    longitude_ = angle_mod_signed(longitude);
-    return *this;
+  auto result = py::reinterpret_borrow<py::array>(out);
+  if (!result.writeable()) {
+    throw std::invalid_argument("Output array should be writeable");
   }
+  return result;
+}
 
-  Position& set_longitude_seconds(const int longitude) {
-    return set_longitude(longitude / 3600.0);
-  }
 
-  bool operator==(const Position& position) const {
-    return floats_equal(latitude_, position.latitude_) && floats_equal(longitude_, position.longitude_);
+/**
+ * Get array to reduce angles in place: out when given, after copying angles
+ * into it, or else a C contiguous copy of angles of float32 when single and
+ * float64 otherwise. Out may be angles itself.
+ */
+py::array angle_output(const py::object& angles, const py::object& out, const bool single) {
+  if (out.is_none()) {
+    return single ? owned_angles<float>(angles) : owned_angles<double>(angles);
   }
-
-  bool operator==(const std::vector<double>& other) const {
-    if (other.size() != 2) {
-      throw std::out_of_range(fmt::format("Can't compare Position to container of size {}", other.size()));
-    }
-    return floats_equal(get_latitude(), other[0]) && floats_equal(get_longitude(), other[1]);
+  py::array result = angle_out(out);
+  if (!result.is(angles)) {
+    get_numpy().attr("copyto")(result, angles);
   }
+  return result;
+}
 
-  Position& operator+=(const Vector& vector) {
-    static const gl::Rhumb& rhumb = gl::Rhumb::WGS84();
-    double latitude;
-    double longitude;
-    rhumb.Direct(latitude_, longitude_, vector.azimuth_, vector.length_, latitude, longitude);
-    latitude_ = latitude;
-    longitude_ = longitude;
-    return *this;
-  }
 
-  Position& operator-=(const Vector& vector) {
-    static const gl::Rhumb& rhumb = gl::Rhumb::WGS84();
-    double latitude;
-    double longitude;
-    rhumb.Direct(latitude_, longitude_, vector.azimuth_, -vector.length_, latitude, longitude);
-    latitude_ = latitude;
-    longitude_ = longitude;
-    return *this;
+/**
+ * Reduce the angles of array in place with reduce(values, size), for float
+ * and double values
+ */
+template <typename Reduce>
+void reduce_in_place(py::array& array, Reduce reduce) {
+  const py::ssize_t size = array.size();
+  if (py::isinstance<FloatArray>(array)) {
+    float* values = static_cast<float*>(array.mutable_data());
+    py::gil_scoped_release release;
+    reduce(values, size);
   }
-
-  Position& operator*=(const Vector& vector) {
-    static const gl::Geodesic& geodesic = gl::Geodesic::WGS84();
-    double latitude;
-    double longitude;
-    double azimuth;
-    geodesic.Direct(latitude_, longitude_, vector.azimuth_, vector.length_, latitude, longitude, azimuth);
-    latitude_ = latitude;
-    longitude_ = longitude;
-    return *this;
+  else {
+    double* values = static_cast<double*>(array.mutable_data());
+    py::gil_scoped_release release;
+    reduce(values, size);
   }
+}
 
-  Position& operator/=(const Vector& vector) {
-    static const gl::Geodesic& geodesic = gl::Geodesic::WGS84();
-    double latitude;
-    double longitude;
-    double azimuth;
-    geodesic.Direct(latitude_, longitude_, vector.azimuth_, -vector.length_, latitude, longitude, azimuth);
-    latitude_ = latitude;
-    longitude_ = longitude;
-    return *this;
-  }
 
-  Position operator+(const Vector& vector) const {
-    Position result(*this);
-    result += vector;
-    return result;
+/**
+ * Scalar angles give a python float, like they did with py::vectorize
+ */
+py::object angle_result(const py::array& result, const py::object& out) {
+  if (out.is_none() && result.ndim() == 0) {
+    return result.attr("item")();
   }
+  return result;
+}
 
-  Position operator-(const Vector& vector) const {
-    Position result(*this);
-    result -= vector;
-    return result;
-  }
 
-  Position operator*(const Vector& vector) const {
-    Position result(*this);
-    result *= vector;
-    return result;
+py::object angle_mod_batch(const py::object& angles, const py::object& out, const int threads) {
+  if (out.is_none() && is_number(angles)) {
+    return py::float_(angle_mod(angles.cast<double>()));
   }
+  py::array result = angle_output(angles, out, is_single(angles));
+  reduce_in_place(result, [&](auto* values, const py::ssize_t size) { angle_mod_array(values, size, threads); });
+  return angle_result(result, out);
+}
 
-  Position operator/(const Vector& vector) const {
-    Position result(*this);
-    result /= vector;
-    return result;
-  }
 
-  double get_item(int i) const {
-    i = i < 0 ? i + 2 : i;
-    switch(i) {
-      case 0: return get_latitude();
-      case 1: return get_longitude();
-      default: throw std::out_of_range(fmt::format("Index {} is out of range for Position", i));
-    }
+py::object angle_mod_signed_batch(const py::object& angles, const py::object& out, const int threads) {
+  if (out.is_none() && is_number(angles)) {
+    return py::float_(angle_mod_signed(angles.cast<double>()));
   }
+  py::array result = angle_output(angles, out, is_single(angles));
+  reduce_in_place(result, [&](auto* values, const py::ssize_t size) { angle_mod_signed_array(values, size, threads); });
+  return angle_result(result, out);
+}
 
-  Position& set_item(int i, const double value) {
-    i = i < 0 ? i + 2 : i;
-    switch(i) {
-      case 0: return set_latitude(value);
-      case 1: return set_longitude(value);
-      default: throw std::out_of_range(fmt::format("Index {} is out of range for Position", i));
-    }
-  }
 
-  constexpr int get_len() const {
-    return 2;
+py::object angle_diff_batch(const py::object& angles1, const py::object& angles2, const py::object& out,
+    const int threads) {
+  if (out.is_none() && is_number(angles1) && is_number(angles2)) {
+    return py::float_(angle_diff(angles1.cast<double>(), angles2.cast<double>()));
   }
-
-  double operator[](const int i) {
-    return get_item(i);
+  // Subtract straight into the result, which is then reduced in place
+  py::array result;
+  if (out.is_none()) {
+    result = py::array::ensure(get_numpy().attr("subtract")(angles1, angles2,
+        "dtype"_a = is_single(angles1) && is_single(angles2) ? "float32" : "float64", "order"_a = "C"));
   }
-
-  std::string get_string() const {
-    return fmt::format("{:.8f}, {:.8f}", latitude_, longitude_);
+  else {
+    result = angle_out(out);
+    get_numpy().attr("subtract")(angles1, angles2, "out"_a = result);
   }
+  reduce_in_place(result, [&](auto* values, const py::ssize_t size) { angle_mod_signed_array(values, size, threads); });
+  return angle_result(result, out);
+}
 
-  std::string get_representation() const {
-    double i;
-    double x_frac = modf(latitude_, &i);
-    double y_frac = modf(longitude_, &i);
-    std::string format = x_frac == 0.0 ? "Position({:.1f}" : "Position({:.15g}";
-    format += y_frac == 0.0 ? ", {:.1f})" : ", {:.15g})";
-    return fmt::format(fmt::runtime(format), latitude_, longitude_);
-  }
 
-private:
-  double latitude_;
-  double longitude_;
-};
+py::tuple normalize_positions_batch(const py::object& latitudes, const py::object& longitudes, const py::object& out,
+    const int threads) {
+  py::object out_latitudes = py::none();
+  py::object out_longitudes = py::none();
+  if (!out.is_none()) {
+    const auto outputs = out.cast<py::tuple>();
+    if (outputs.size() != 2) {
+      throw std::invalid_argument("Output should be a tuple of latitude and longitude arrays");
+    }
+    out_latitudes = outputs[0];
+    out_longitudes = outputs[1];
+  }
+  const bool single = is_single(latitudes) && is_single(longitudes);
+  py::array result_latitudes = angle_output(latitudes, out_latitudes, single);
+  py::array result_longitudes = angle_output(longitudes, out_longitudes, single);
+  if (get_shape(result_latitudes) != get_shape(result_longitudes)) {
+    throw std::invalid_argument(fmt::format("Latitudes of shape ({}) and longitudes of shape ({}) don't match",
+        fmt::join(get_shape(result_latitudes), ", "), fmt::join(get_shape(result_longitudes), ", ")));
+  }
+  const py::ssize_t size = result_latitudes.size();
+  if (py::isinstance<FloatArray>(result_latitudes) && py::isinstance<FloatArray>(result_longitudes)) {
+    float* latitude = static_cast<float*>(result_latitudes.mutable_data());
+    float* longitude = static_cast<float*>(result_longitudes.mutable_data());
+    py::gil_scoped_release release;
+    normalize_positions(latitude, longitude, size, threads);
+  }
+  else if (py::isinstance<OutputArray>(result_latitudes) && py::isinstance<OutputArray>(result_longitudes)) {
+    double* latitude = static_cast<double*>(result_latitudes.mutable_data());
+    double* longitude = static_cast<double*>(result_longitudes.mutable_data());
+    py::gil_scoped_release release;
+    normalize_positions(latitude, longitude, size, threads);
+  }
+  else {
+    throw std::invalid_argument("Output arrays of latitudes and longitudes should have the same dtype");
+  }
+  return py::make_tuple(angle_result(result_latitudes, out_latitudes), angle_result(result_longitudes, out_longitudes));
+}
 
 
-Vector operator-(const Position& position2, const Position& position1) {
-  static const gl::Rhumb& rhumb = gl::Rhumb::WGS84();
-  double azimuth;
-  double distance;
-  rhumb.Inverse(
-      position1.get_latitude(),
-      position1.get_longitude(),
-      position2.get_latitude(),
-      position2.get_longitude(),
-      distance,
-      azimuth
-  );
-  return Vector(azimuth, distance);
-}
-
-
-Vector operator/(const Position& position2, const Position& position1) {
-  static const gl::Geodesic& geodesic = gl::Geodesic::WGS84();
-  double azimuth1;
-  double azimuth2;
-  double distance;
-  geodesic.Inverse(
-      position1.get_latitude(),
-      position1.get_longitude(),
-      position2.get_latitude(),
-      position2.get_longitude(),
-      distance,
-      azimuth1,
-      azimuth2
-  );
-  return Vector(azimuth1, distance);
-}
-
-std::vector<Position> Vector::split_ortho(const Position& start, const int number_of_segments) const {
-  std::vector<Position> result{};
-  Position position = start;
-  Position end = start * *this;
-  result.push_back(position);
-  for (int i = number_of_segments; i > 0; --i) {
-    position *= (end / position) / double(i);
-    result.push_back(position);
-  }
+py::array readonly_view(const double* data, const size_t size, const py::handle base) {
+  py::array result(py::dtype::of<double>(), {static_cast<py::ssize_t>(size)}, {}, data, base);
+  result.attr("setflags")("write"_a = false);
   return result;
 }
 
-std::vector<Position> Vector::split_loxo(const Position& start, const int number_of_segments) const {
-  std::vector<Position> result{};
-  Position position = start;
-  result.push_back(position);
-  Vector segment = *this / double(number_of_segments);
-  for (int i = 0; i < number_of_segments; ++i) {
-    position += segment;
-    result.push_back(position);
-  }
-  return result;
-}
 
 PYBIND11_MODULE(geofun, m) {
   m.doc() = "Geographic utilities: orthodrome/loxodrome, geodesic/rhumb line evaluation.";
 
+  // GeographicLib calls don't need the GIL
+  const auto release_gil = py::call_guard<py::gil_scoped_release>();
+
   m.def("get_version", &get_version,
       "Get the library version");
+  m.def("get_threads", &get_threads,
+      "Get the number of threads used by batch functions");
+  m.def("set_threads", &set_threads, "threads"_a,
+      "Set the number of threads used by batch functions. Zero selects one thread per hardware core.");
+  m.attr("stats_enabled") = stats_enabled;
+  m.def("stats", &stats,
+      "Get the number of calls, elements processed and time in seconds per instrumented function since the last "
+      "reset. Empty unless built with GEOFUN_STATS.");
+  m.def("reset_stats", &reset_stats,
+      "Reset the counters of the instrumented functions");
+
+  py::class_<Ellipsoid>(m, "Ellipsoid")
+    .def(py::init<double, double>(), "equatorial_radius"_a, "flattening"_a,
+        "Construct ellipsoid from equatorial radius in meters and flattening")
+    .def_static("wgs84", []() { return &get_wgs84(); }, py::return_value_policy::reference,
+        "Get the WGS84 ellipsoid, which is the default")
+    .def_property_readonly("equatorial_radius", &Ellipsoid::get_equatorial_radius)
+    .def_property_readonly("flattening", &Ellipsoid::get_flattening)
+    .def(py::self == py::self)
+    .def("__repr__", &Ellipsoid::get_representation)
+    .def(py::pickle(
+      [](const Ellipsoid& e) {
+        return py::make_tuple(e.get_equatorial_radius(), e.get_flattening());
+      },
+      [](const py::tuple t) {
+        if (t.size() != 2)
+          throw std::runtime_error("Ellipsoid pickle: Invalid state!");
+        return Ellipsoid(t[0].cast<double>(), t[1].cast<double>());
+      }
+    ))
+    ;
 
   // GeographicLib wrappers
-  m.def("rhumb_direct", &rhumb_direct, "latitude"_a, "longitude"_a, "azimuth"_a, "distance"_a,
-      "Get position and final azimuth after moving distance from starting position at fixed azimuth/along rhumb line");
-  m.def("rhumb_inverse", &rhumb_inverse, "latitude1"_a, "longitude1"_a, "latitude2"_a, "longitude2"_a,
-      "Get rhumb line azimuth, distance and final azimuth between positions");
-  m.def("geodesic_direct", &geodesic_direct, "latitude"_a, "longitude"_a, "azimuth"_a, "distance"_a,
-      "Get position and final azimuth after moving distance along great circle with starting azimuth");
-  m.def("geodesic_inverse", &geodesic_inverse, "latitude1"_a, "longitude1"_a, "latitude2"_a, "longitude2"_a,
-      "Get starting azimuth, distance and ending azimuth of great circle between positions");
+  m.def("rhumb_direct", &rhumb_direct, "latitude"_a, "longitude"_a, "azimuth"_a, "distance"_a, "ellipsoid"_a = py::none(),
+      "Get position and final azimuth after moving distance from starting position at fixed azimuth/along rhumb line",
+      release_gil);
+  m.def("rhumb_inverse", &rhumb_inverse, "latitude1"_a, "longitude1"_a, "latitude2"_a, "longitude2"_a, "ellipsoid"_a = py::none(),
+      "Get rhumb line azimuth, distance and final azimuth between positions",
+      release_gil);
+  m.def("geodesic_direct", &geodesic_direct, "latitude"_a, "longitude"_a, "azimuth"_a, "distance"_a, "ellipsoid"_a = py::none(),
+      "Get position and final azimuth after moving distance along great circle with starting azimuth",
+      release_gil);
+  m.def("geodesic_inverse", &geodesic_inverse, "latitude1"_a, "longitude1"_a, "latitude2"_a, "longitude2"_a, "ellipsoid"_a = py::none(),
+      "Get starting azimuth, distance and ending azimuth of great circle between positions",
+      release_gil);
+  m.def("rhumb_direct_batch", &rhumb_direct_batch,
+      "latitude"_a, "longitude"_a, "azimuth"_a, "distance"_a, "out"_a = py::none(), "threads"_a = 0,
+      "ellipsoid"_a = py::none(),
+      "Get positions and final azimuths for arrays of starting positions, azimuths and distances along rhumb lines. "
+      "Arguments are broadcast against each other. Large batches are split over threads. Returns array with trailing dimension of 3: latitude, longitude, azimuth");
+  m.def("rhumb_inverse_batch", &rhumb_inverse_batch,
+      "latitude1"_a, "longitude1"_a, "latitude2"_a, "longitude2"_a, "out"_a = py::none(), "threads"_a = 0,
+      "ellipsoid"_a = py::none(),
+      "Get rhumb line azimuths, distances and final azimuths between arrays of positions. "
+      "Arguments are broadcast against each other. Large batches are split over threads. Returns array with trailing dimension of 3: azimuth1, distance, azimuth2");
+  m.def("geodesic_direct_batch", &geodesic_direct_batch,
+      "latitude"_a, "longitude"_a, "azimuth"_a, "distance"_a, "out"_a = py::none(), "threads"_a = 0,
+      "ellipsoid"_a = py::none(),
+      "Get positions and final azimuths for arrays of starting positions, azimuths and distances along great circles. "
+      "Arguments are broadcast against each other. Large batches are split over threads. Returns array with trailing dimension of 3: latitude, longitude, azimuth");
+  m.def("geodesic_inverse_batch", &geodesic_inverse_batch,
+      "latitude1"_a, "longitude1"_a, "latitude2"_a, "longitude2"_a, "out"_a = py::none(), "threads"_a = 0,
+      "ellipsoid"_a = py::none(),
+      "Get starting azimuths, distances and ending azimuths of great circles between arrays of positions. "
+      "Arguments are broadcast against each other. Large batches are split over threads. Returns array with trailing dimension of 3: azimuth1, distance, azimuth2");
+  m.def("rhumb_distance_batch", &rhumb_distance_batch,
+      "latitude1"_a, "longitude1"_a, "latitude2"_a, "longitude2"_a, "out"_a = py::none(), "threads"_a = 0,
+      "ellipsoid"_a = py::none(),
+      "Get only the distances along rhumb lines between arrays of positions, which skips computing the azimuths. "
+      "Arguments are broadcast against each other. Large batches are split over threads.");
+  m.def("rhumb_azimuth_batch", &rhumb_azimuth_batch,
+      "latitude1"_a, "longitude1"_a, "latitude2"_a, "longitude2"_a, "out"_a = py::none(), "threads"_a = 0,
+      "ellipsoid"_a = py::none(),
+      "Get only the starting azimuths of rhumb lines between arrays of positions, which skips computing the distances. "
+      "Arguments are broadcast against each other. Large batches are split over threads.");
+  m.def("geodesic_distance_batch", &geodesic_distance_batch,
+      "latitude1"_a, "longitude1"_a, "latitude2"_a, "longitude2"_a, "out"_a = py::none(), "threads"_a = 0,
+      "ellipsoid"_a = py::none(),
+      "Get only the distances along great circles between arrays of positions, which skips computing the azimuths. "
+      "Arguments are broadcast against each other. Large batches are split over threads.");
+  m.def("geodesic_azimuth_batch", &geodesic_azimuth_batch,
+      "latitude1"_a, "longitude1"_a, "latitude2"_a, "longitude2"_a, "out"_a = py::none(), "threads"_a = 0,
+      "ellipsoid"_a = py::none(),
+      "Get only the starting azimuths of great circles between arrays of positions, which skips computing the distances. "
+      "Arguments are broadcast against each other. Large batches are split over threads.");
+
+  m.def("haversine_distance", &haversine_distance,
+      "latitude1"_a, "longitude1"_a, "latitude2"_a, "longitude2"_a, "out"_a = py::none(), "threads"_a = 0,
+      "ellipsoid"_a = py::none(),
+      "Get great circle distances on a sphere with the mean radius of the ellipsoid. Off by up to 0.6%");
+  m.def("equirectangular_distance", &equirectangular_distance,
+      "latitude1"_a, "longitude1"_a, "latitude2"_a, "longitude2"_a, "out"_a = py::none(), "threads"_a = 0,
+      "ellipsoid"_a = py::none(),
+      "Get distances on the local flat plane at the mean latitude. "
+      "Off by less than 0.1% up to 100 km below 80 degrees latitude");
+  m.def("andoyer_lambert_distance", &andoyer_lambert_distance,
+      "latitude1"_a, "longitude1"_a, "latitude2"_a, "longitude2"_a, "out"_a = py::none(), "threads"_a = 0,
+      "ellipsoid"_a = py::none(),
+      "Get distances with Lambert's flattening correction to great circle distances. Off by less than 0.01%");
+  m.def("geodesic_within", &geodesic_within,
+      "latitude1"_a, "longitude1"_a, "latitude2"_a, "longitude2"_a, "radius"_a, "threads"_a = 0, "ellipsoid"_a = py::none(),
+      "Check whether geodesic distances between positions are at most radius. "
+      "Exact distances are only computed near radius");
+  m.def("parse_positions", &parse_positions, "records"_a, "format"_a = "dms", "threads"_a = 0,
+      "Parse positions from a sequence of strings or from the lines of a str, bytes or bytearray. Format is \"dms\" for strings "
+      "like Position takes or \"nmea\" for NMEA 0183 fields \"ddmm.mmmm,N,dddmm.mmmm,E\". Returns (N, 2) array "
+      "of latitudes and longitudes and boolean array telling which records are valid. Invalid records give NaN");
+  m.def("track_metrics", &track_metrics,
+      "times"_a, "latitudes"_a, "longitudes"_a, "ids"_a = py::none(), "metric"_a = "geodesic", "threads"_a = 0,
+      "ellipsoid"_a = py::none(),
+      "Get dictionary of per record arrays: distances, azimuths and final_azimuths of the legs from the previous "
+      "records, speeds in m/s, courses over ground, cumulative_distances and turn_rates in degrees per second. "
+      "Records of a track are consecutive; when ids are given, each change of id starts a new track");
+  m.def("simplify", &simplify,
+      "latitudes"_a, "longitudes"_a, "tolerance"_a, "ids"_a = py::none(), "threads"_a = 0, "ellipsoid"_a = py::none(),
+      "Simplify tracks with the Douglas-Peucker algorithm on geodesics, keeping all records within tolerance meters "
+      "cross track distance of the simplified tracks. Returns indices of the kept records. Records of a track are "
+      "consecutive; when ids are given, each change of id starts a new track");
+  m.def("distance_matrix", &distance_matrix,
+      "positions1"_a, "positions2"_a = py::none(), "metric"_a = "geodesic", "out"_a = py::none(), "threads"_a = 0,
+      "ellipsoid"_a = py::none(),
+      "Get (M, N) matrix of distances between M positions1 and N positions2, given as PositionArray or (N, 2) array. "
+      "Metric is one of \"geodesic\", \"rhumb\" or \"haversine\". When positions2 is None, "
+      "the symmetric matrix for positions1 is computed, evaluating each pair only once.");
 
   // Angle arithmetic
-  m.def("angle_mod", py::vectorize(angle_mod),
-      "Return angle bound to [0.0, 360.0>");
-  m.def("angle_mod_signed", py::vectorize(angle_mod_signed),
-      "Return angle bound to [-180.0, 180.0>");
-  m.def("angle_diff", py::vectorize(angle_diff),
-      "Signed difference between to angles");
+  m.def("angle_mod", &angle_mod_batch, "angles"_a, "out"_a = py::none(), "threads"_a = 0,
+      "Return angles bound to [0.0, 360.0>. Float32 angles stay float32. When out is given, the results are written "
+      "into it, which may be angles itself to bound them in place.");
+  m.def("angle_mod_signed", &angle_mod_signed_batch, "angles"_a, "out"_a = py::none(), "threads"_a = 0,
+      "Return angles bound to [-180.0, 180.0>, like angle_mod");
+  m.def("angle_diff", &angle_diff_batch, "angles1"_a, "angles2"_a, "out"_a = py::none(), "threads"_a = 0,
+      "Signed difference between two angles, bound to [-180.0, 180.0>");
+  m.def("normalize_positions", &normalize_positions_batch,
+      "latitudes"_a, "longitudes"_a, "out"_a = py::none(), "threads"_a = 0,
+      "Normalize latitudes and longitudes like Position does. Returns tuple of latitudes and longitudes. When out is "
+      "a tuple of two arrays, the results are written into them, which may be the inputs to normalize in place.");
 
   // Primitives
-  py::class_<Point>(m, "Point")
+  py::class_<Point>(m, "Point", py::buffer_protocol())
     .def(py::init<>(),
         "Construct new point.")
     .def(py::init<Point&>(),
         "Copy construct point.")
     .def(py::init<const double, const double>(), "x"_a, "y"_a,
         "Construct point from coordinate pair x, y.")
+    .def(py::init([](const DoubleArray& values) {
+          auto pair = get_pair(values, "Point");
+          return Point(pair.first, pair.second);
+        }),
+        "Construct point from buffer of two values.")
     .def(py::init<const std::vector<double>&>(),
         "Construct point from initializer list.")
+    .def_buffer([](Point& self) {
+      return py::buffer_info(self.data(), sizeof(double), py::format_descriptor<double>::format(),
+          1, {2}, {sizeof(double)}, false);
+    })
     .def("__getitem__", &Point::get_item)
     .def("__setitem__", &Point::set_item)
     .def("__len__", &Point::get_len)
@@ -895,15 +1648,24 @@ PYBIND11_MODULE(geofun, m) {
     ))
     ;
 
-  py::class_<Vector>(m, "Vector")
+  py::class_<Vector>(m, "Vector", py::buffer_protocol())
     .def(py::init<>(),
         "Construct new vector.")
     .def(py::init<Vector&>(),
         "Copy construct vector.")
     .def(py::init<const double, const double>(), "azimuth"_a, "length"_a,
         "Construct vector from pair of azimuth and length.")
+    .def(py::init([](const DoubleArray& values) {
+          auto pair = get_pair(values, "Vector");
+          return Vector(pair.first, pair.second);
+        }),
+        "Construct vector from buffer of two values.")
     .def(py::init<const std::vector<double>&>(),
         "Construct vector from initializer list.")
+    .def_buffer([](Vector& self) {
+      return py::buffer_info(const_cast<double*>(self.data()), sizeof(double), py::format_descriptor<double>::format(),
+          1, {2}, {sizeof(double)}, true);
+    })
     .def("__getitem__", &Vector::get_item)
     .def("__setitem__", &Vector::set_item)
     .def("__len__", &Vector::get_len)
@@ -922,9 +1684,20 @@ PYBIND11_MODULE(geofun, m) {
     .def("point", &Vector::point,
         "Return copy of vector as Point with x, y coordinates.")
     .def("split_ortho", &Vector::split_ortho, py::arg("start"), py::arg("number_of_segments"),
-        "Split orthodromic vector from start position into number of segments")
+        py::arg("ellipsoid") = py::none(),
+        "Split orthodromic vector from start position into number of segments", release_gil)
     .def("split_loxo", &Vector::split_loxo, py::arg("start"), py::arg("number_of_segments"),
-        "Split loxodromic vector from start position into number of segments")
+        py::arg("ellipsoid") = py::none(),
+        "Split loxodromic vector from start position into number of segments", release_gil)
+    .def("split_ortho_array", &split_ortho_array, py::arg("start"), py::arg("number_of_segments"), py::arg("threads") = 0, py::arg("ellipsoid") = py::none(),
+        "Split orthodromic vector from start position into number of segments. Returns (N + 1, 2) array of "
+        "latitudes and longitudes")
+    .def("split_loxo_array", &split_loxo_array, py::arg("start"), py::arg("number_of_segments"), py::arg("threads") = 0, py::arg("ellipsoid") = py::none(),
+        "Split loxodromic vector from start position into number of segments. Returns (N + 1, 2) array of "
+        "latitudes and longitudes")
+    .def("sample_ortho", &sample_ortho, py::arg("start"), py::arg("spacing"), py::arg("threads") = 0, py::arg("ellipsoid") = py::none(),
+        "Sample orthodromic vector from start position every spacing meters. Returns (N, 2) array of "
+        "latitudes and longitudes, ending at the end of the vector")
     .def_property("azimuth", &Vector::get_azimuth, &Vector::set_azimuth,
         "Azimuth of vector")
     .def_property("length", &Vector::get_length, &Vector::set_length,
@@ -965,7 +1738,7 @@ PYBIND11_MODULE(geofun, m) {
     ))
     ;
 
-  py::class_<Position>(m, "Position")
+  py::class_<Position>(m, "Position", py::buffer_protocol())
     .def(py::init<>(),
         "Construct new position.")
     .def(py::init<Position&>(),
@@ -974,8 +1747,17 @@ PYBIND11_MODULE(geofun, m) {
         "Construct position from decimal degrees of angle.")
     .def(py::init<const int, const int>(), "lat_seconds"_a, "lon_seconds"_a,
         "Construct position from seconds of angle.")
+    .def(py::init([](const DoubleArray& values) {
+          auto pair = get_pair(values, "Position");
+          return Position(pair.first, pair.second);
+        }),
+        "Construct position from buffer of two values.")
     .def(py::init<const std::vector<double>&>(),
         "Construct position from initializer list.")
+    .def_buffer([](Position& self) {
+      return py::buffer_info(const_cast<double*>(self.data()), sizeof(double), py::format_descriptor<double>::format(),
+          1, {2}, {sizeof(double)}, true);
+    })
     .def(py::init<const std::string&, const std::string&>(), "lat_string"_a, "lon_string"_a = "",
         "Construct position from pair of strings")
     .def("__getitem__", &Position::get_item)
@@ -993,16 +1775,16 @@ PYBIND11_MODULE(geofun, m) {
         "Longitude of position")
     .def(py::self == py::self)
     .def(py::self == std::vector<double>())
-    .def(py::self - py::self)
-    .def(py::self / py::self)
-    .def(py::self += Vector())
-    .def(py::self + Vector())
-    .def(py::self -= Vector())
-    .def(py::self - Vector())
-    .def(py::self *= Vector())
-    .def(py::self * Vector())
-    .def(py::self /= Vector())
-    .def(py::self / Vector())
+    .def(py::self - py::self, release_gil)
+    .def(py::self / py::self, release_gil)
+    .def(py::self += Vector(), release_gil)
+    .def(py::self + Vector(), release_gil)
+    .def(py::self -= Vector(), release_gil)
+    .def(py::self - Vector(), release_gil)
+    .def(py::self *= Vector(), release_gil)
+    .def(py::self * Vector(), release_gil)
+    .def(py::self /= Vector(), release_gil)
+    .def(py::self / Vector(), release_gil)
     .def(py::pickle(
       [](const Position& p) {
         return py::make_tuple(p.get_latitude(), p.get_longitude());
@@ -1015,4 +1797,281 @@ PYBIND11_MODULE(geofun, m) {
       }
     ))
     ;
+
+  // Arrays
+  py::class_<VectorArray>(m, "VectorArray", py::buffer_protocol())
+    .def(py::init<>(),
+        "Construct new empty vector array.")
+    .def(py::init<VectorArray&>(),
+        "Copy construct vector array.")
+    .def(py::init<const size_t>(), "size"_a,
+        "Construct vector array of size zero length vectors.")
+    .def(py::init([](const DoubleArray& azimuths, const DoubleArray& lengths) {
+          return vector_array(azimuths, lengths);
+        }), "azimuths"_a, "lengths"_a,
+        "Construct vector array from arrays of azimuths and lengths.")
+    .def(py::init([](const DoubleArray& values) { return vector_array(values); }), "values"_a,
+        "Construct vector array from (N, 2) array of azimuths and lengths.")
+    .def(py::init<const std::vector<Vector>&>(), "vectors"_a,
+        "Construct vector array from list of vectors.")
+    .def_buffer([](VectorArray& self) {
+      const py::ssize_t size = self.size();
+      return py::buffer_info(self.azimuths(), sizeof(double), py::format_descriptor<double>::format(),
+          2, {py::ssize_t(2), size}, {size * py::ssize_t(sizeof(double)), py::ssize_t(sizeof(double))}, true);
+    })
+    .def("__getitem__", &VectorArray::get_item)
+    .def("__setitem__", &VectorArray::set_item)
+    .def("__len__", &VectorArray::get_len)
+    .def("__repr__", &VectorArray::get_representation)
+    .def("__copy__", [](const VectorArray& self) { return VectorArray(self); })
+    .def("__deepcopy__", [](const VectorArray& self, py::dict) { return VectorArray(self); }, "memo"_a)
+    .def("copy", [](const VectorArray& self) { return VectorArray(self); },
+        "Return a copy of this vector array.")
+    .def_property_readonly("azimuths", [](const py::object& self) {
+          const auto& vectors = self.cast<const VectorArray&>();
+          return readonly_view(vectors.azimuths(), vectors.size(), self);
+        },
+        "Read only view of the azimuths of the vectors")
+    .def_property_readonly("lengths", [](const py::object& self) {
+          const auto& vectors = self.cast<const VectorArray&>();
+          return readonly_view(vectors.lengths(), vectors.size(), self);
+        },
+        "Read only view of the lengths of the vectors")
+    .def(py::self == py::self)
+    .def(py::self += py::self, release_gil)
+    .def(py::self + py::self, release_gil)
+    .def(py::self -= py::self, release_gil)
+    .def(py::self - py::self, release_gil)
+    .def(py::self *= double(), release_gil)
+    .def(py::self /= double(), release_gil)
+    .def(double() * py::self, release_gil)
+    .def(py::self * double(), release_gil)
+    .def(py::self / double(), release_gil)
+    .def(py::self += double(), release_gil)
+    .def(double() + py::self, release_gil)
+    .def(py::self + double(), release_gil)
+    .def(py::self -= double(), release_gil)
+    .def(double() - py::self, release_gil)
+    .def(py::self - double(), release_gil)
+    .def(-py::self, release_gil)
+    .def(py::pickle(
+      [](const VectorArray& v) {
+        return py::make_tuple(
+            py::array_t<double>(v.size(), v.azimuths()), py::array_t<double>(v.size(), v.lengths()));
+      },
+      [](const py::tuple t) {
+        if (t.size() != 2)
+          throw std::runtime_error("VectorArray pickle: Invalid state!");
+        return vector_array(t[0].cast<DoubleArray>(), t[1].cast<DoubleArray>());
+      }
+    ))
+    ;
+
+  py::class_<PositionArray>(m, "PositionArray", py::buffer_protocol())
+    .def(py::init<>(),
+        "Construct new empty position array.")
+    .def(py::init<PositionArray&>(),
+        "Copy construct position array.")
+    .def(py::init<const size_t>(), "size"_a,
+        "Construct position array of size positions at 0, 0.")
+    .def(py::init([](const DoubleArray& latitudes, const DoubleArray& longitudes) {
+          return position_array(latitudes, longitudes);
+        }), "latitudes"_a, "longitudes"_a,
+        "Construct position array from arrays of latitudes and longitudes.")
+    .def(py::init([](const DoubleArray& values) { return position_array(values); }), "values"_a,
+        "Construct position array from (N, 2) array of latitudes and longitudes.")
+    .def(py::init<const std::vector<Position>&>(), "positions"_a,
+        "Construct position array from list of positions.")
+    .def_buffer([](PositionArray& self) {
+      const py::ssize_t size = self.size();
+      return py::buffer_info(self.latitudes(), sizeof(double), py::format_descriptor<double>::format(),
+          2, {py::ssize_t(2), size}, {size * py::ssize_t(sizeof(double)), py::ssize_t(sizeof(double))}, true);
+    })
+    .def("__getitem__", &PositionArray::get_item)
+    .def("__setitem__", &PositionArray::set_item)
+    .def("__len__", &PositionArray::get_len)
+    .def("__repr__", &PositionArray::get_representation)
+    .def("__copy__", [](const PositionArray& self) { return PositionArray(self); })
+    .def("__deepcopy__", [](const PositionArray& self, py::dict) { return PositionArray(self); }, "memo"_a)
+    .def("copy", [](const PositionArray& self) { return PositionArray(self); },
+        "Return a copy of this position array.")
+    .def_property_readonly("latitudes", [](const py::object& self) {
+          const auto& positions = self.cast<const PositionArray&>();
+          return readonly_view(positions.latitudes(), positions.size(), self);
+        },
+        "Read only view of the latitudes of the positions")
+    .def_property_readonly("longitudes", [](const py::object& self) {
+          const auto& positions = self.cast<const PositionArray&>();
+          return readonly_view(positions.longitudes(), positions.size(), self);
+        },
+        "Read only view of the longitudes of the positions")
+    .def(py::self - py::self, release_gil)
+    .def(py::self / py::self, release_gil)
+    .def(py::self - Position(), release_gil)
+    .def(Position() - py::self, release_gil)
+    .def(py::self / Position(), release_gil)
+    .def(Position() / py::self, release_gil)
+    .def(py::self += VectorArray(), release_gil)
+    .def(py::self + VectorArray(), release_gil)
+    .def(py::self -= VectorArray(), release_gil)
+    .def(py::self - VectorArray(), release_gil)
+    .def(py::self *= VectorArray(), release_gil)
+    .def(py::self * VectorArray(), release_gil)
+    .def(py::self /= VectorArray(), release_gil)
+    .def(py::self / VectorArray(), release_gil)
+    .def(py::self += Vector(), release_gil)
+    .def(py::self + Vector(), release_gil)
+    .def(py::self -= Vector(), release_gil)
+    .def(py::self - Vector(), release_gil)
+    .def(py::self *= Vector(), release_gil)
+    .def(py::self * Vector(), release_gil)
+    .def(py::self /= Vector(), release_gil)
+    .def(py::self / Vector(), release_gil)
+    .def(py::pickle(
+      [](const PositionArray& p) {
+        return py::make_tuple(
+            py::array_t<double>(p.size(), p.latitudes()), py::array_t<double>(p.size(), p.longitudes()));
+      },
+      [](const py::tuple t) {
+        if (t.size() != 2)
+          throw std::runtime_error("PositionArray pickle: Invalid state!");
+        return position_array(t[0].cast<DoubleArray>(), t[1].cast<DoubleArray>());
+      }
+    ))
+    ;
+
+  py::class_<TrackReader>(m, "TrackReader")
+    .def(py::init<const std::string&, const std::string&, py::ssize_t, const std::optional<std::string>&,
+          const std::string&, const std::string&, char, bool, const std::string&, const Ellipsoid*>(),
+        "path"_a, "format"_a = "csv", "chunk_size"_a = 65536, "time_column"_a = "time",
+        "latitude_column"_a = "latitude", "longitude_column"_a = "longitude", "delimiter"_a = ',',
+        "legs"_a = false, "metric"_a = "geodesic", "ellipsoid"_a = py::none(),
+        "Open CSV or NMEA track file for reading in chunks of at most chunk_size records. "
+        "CSV files need a header naming the columns. Time column values are ISO 8601 or seconds since the epoch; "
+        "when time_column is None, times are NaN. NMEA files are read from RMC and GGA sentences; "
+        "GGA sentences take the date of the last RMC sentence and are ignored before the first. "
+        "When legs is True, distances and azimuths from the previous records are computed with metric "
+        "\"geodesic\" or \"rhumb\".")
+    .def("__iter__", [](TrackReader& reader) -> TrackReader& { return reader; }, py::return_value_policy::reference_internal)
+    .def("__next__", &read_chunk,
+        "Get next chunk as dictionary with arrays \"times\", \"latitudes\", \"longitudes\" and optionally "
+        "\"distances\" and \"azimuths\"")
+    .def_property_readonly("skipped", &TrackReader::get_skipped,
+        "Number of records that couldn't be parsed")
+    ;
+
+  py::class_<PositionIndex>(m, "PositionIndex")
+    .def(py::init([](const py::object& positions, const Ellipsoid* ellipsoid) {
+          return PositionIndex(Coordinates(positions), get_ellipsoid(ellipsoid));
+        }), "positions"_a, "ellipsoid"_a = py::none(),
+        "Construct spatial index on PositionArray or (N, 2) array of latitudes and longitudes.")
+    .def("__len__", &PositionIndex::size)
+    .def("nearest", &index_nearest, "positions"_a, "count"_a = 1, "threads"_a = 0,
+        "Find the count nearest indexed positions by geodesic distance for each of the query positions. "
+        "Returns (N, count) arrays of indices and distances, sorted by distance. "
+        "Missing neighbours have index -1 and infinite distance.")
+    .def("within", &index_within, "positions"_a, "radius"_a, "threads"_a = 0,
+        "Find the indexed positions within radius meters geodesic distance of each of the query positions. "
+        "Radius is a single value or one per query position. Returns arrays of offsets, indices and distances: "
+        "the results for query position i, sorted by distance, are at offsets[i]:offsets[i + 1].")
+    ;
+
+  py::class_<Polygon>(m, "Polygon")
+    .def(py::init([](const py::object& positions, const Ellipsoid* ellipsoid) {
+          return Polygon(Coordinates(positions), get_ellipsoid(ellipsoid));
+        }), "positions"_a, "ellipsoid"_a = py::none(),
+        "Construct polygon from PositionArray or (N, 2) array of latitudes and longitudes of its vertices. "
+        "The polygon is closed implicitly.")
+    .def("__len__", &Polygon::size)
+    .def_property_readonly("latitudes", [](const py::object& self) {
+          const auto& polygon = self.cast<const Polygon&>();
+          return readonly_view(polygon.latitudes(), polygon.size(), self);
+        },
+        "Read only array of vertex latitudes")
+    .def_property_readonly("longitudes", [](const py::object& self) {
+          const auto& polygon = self.cast<const Polygon&>();
+          return readonly_view(polygon.longitudes(), polygon.size(), self);
+        },
+        "Read only array of vertex longitudes")
+    .def("area", &Polygon::get_area, "kind"_a = "ortho",
+        "Get area in square meters with \"ortho\" or \"loxo\" edges, regardless of vertex orientation",
+        release_gil)
+    .def("perimeter", &Polygon::get_perimeter, "kind"_a = "ortho",
+        "Get perimeter in meters with \"ortho\" or \"loxo\" edges",
+        release_gil)
+    .def("contains", [](const Polygon& polygon, const Position& position, const std::string& kind) {
+          return polygon.contains(position.get_latitude(), position.get_longitude(), get_line_kind(kind));
+        }, "position"_a, "kind"_a = "ortho",
+        "Test whether position is inside the polygon with \"ortho\" or \"loxo\" edges")
+    .def("contains", &polygon_contains, "positions"_a, "kind"_a = "ortho", "threads"_a = 0,
+        "Test PositionArray or (N, 2) array of positions for being inside the polygon with \"ortho\" or \"loxo\" "
+        "edges. Returns boolean array")
+    ;
+
+  py::class_<Projector>(m, "Projector")
+    .def(py::init([](const Position& origin, const std::string& kind, const Ellipsoid* ellipsoid) {
+          return Projector(origin, kind, get_ellipsoid(ellipsoid));
+        }), "origin"_a, "kind"_a = "local", "ellipsoid"_a = py::none(),
+        "Construct projection around origin of kind \"local\" (tangent plane), \"transverse_mercator\" or "
+        "\"azimuthal_equidistant\". Points have x pointing north and y pointing east.")
+    .def_property_readonly("origin", &Projector::get_origin, "Origin of the projection")
+    .def("forward", static_cast<Point (Projector::*)(const Position&) const>(&Projector::forward), "position"_a,
+        "Project position to point", release_gil)
+    .def("forward", &project_forward, "positions"_a, "out"_a = py::none(), "threads"_a = 0,
+        "Project PositionArray or (N, 2) array of latitudes and longitudes to (N, 2) array of x and y")
+    .def("reverse", static_cast<Position (Projector::*)(const Point&) const>(&Projector::reverse), "point"_a,
+        "Get position of point", release_gil)
+    .def("reverse", &project_reverse, "points"_a, "out"_a = py::none(), "threads"_a = 0,
+        "Get (N, 2) array of latitudes and longitudes of (N, 2) array of x and y")
+    ;
+
+  // Grid references
+  m.def("utm_encode", &utm_encode, "latitudes"_a, "longitudes"_a, "threads"_a = 0,
+      "Get UTM/UPS zones (0 for UPS), hemispheres (True for north) and (N, 2) array of eastings and northings "
+      "of positions. Positions that can't be converted get zone -4 and NaN coordinates");
+  m.def("utm_decode", &utm_decode, "zones"_a, "north"_a, "coordinates"_a, "threads"_a = 0,
+      "Get (N, 2) array of latitudes and longitudes of UTM/UPS zones, hemispheres and (N, 2) array of eastings "
+      "and northings. Invalid coordinates give NaN");
+  m.def("mgrs_encode", &mgrs_encode, "latitudes"_a, "longitudes"_a, "precision"_a = 5, "threads"_a = 0,
+      "Get MGRS references of positions with precision digits per coordinate as fixed width bytes array. "
+      "Positions that can't be converted give empty references");
+  m.def("mgrs_decode", &mgrs_decode, "codes"_a, "threads"_a = 0,
+      "Get (N, 2) array of latitudes and longitudes of the centers of MGRS references, from a bytes array or "
+      "sequence of strings. Invalid references give NaN");
+  m.def("geohash_encode", &geohash_encode, "latitudes"_a, "longitudes"_a, "length"_a = 12, "threads"_a = 0,
+      "Get geohashes of length characters of positions as fixed width bytes array. "
+      "Positions that can't be converted give empty geohashes");
+  m.def("geohash_decode", &geohash_decode, "codes"_a, "threads"_a = 0,
+      "Get (N, 2) array of latitudes and longitudes of the centers of geohash cells, from a bytes array or "
+      "sequence of strings. Invalid geohashes give NaN");
+
+  // Line and approach kernels
+  m.def("cross_track", &cross_track, "start"_a, "end"_a, "position"_a, "kind"_a = "ortho", "ellipsoid"_a = py::none(),
+      "Get cross track distance, positive to the right, and along track distance of position relative to the "
+      "orthodrome or loxodrome from start to end, with kind \"ortho\" or \"loxo\"",
+      release_gil);
+  m.def("cross_track_batch", &cross_track_batch,
+      "start_latitude"_a, "start_longitude"_a, "end_latitude"_a, "end_longitude"_a, "latitude"_a, "longitude"_a,
+      "kind"_a = "ortho", "out"_a = py::none(), "threads"_a = 0, "ellipsoid"_a = py::none(),
+      "Array version of cross_track. Arguments are broadcast against each other. "
+      "Returns array with trailing dimension of 2: cross track distance, along track distance");
+  m.def("cpa", &cpa, "position1"_a, "velocity1"_a, "position2"_a, "velocity2"_a, "ellipsoid"_a = py::none(),
+      "Get time in seconds and distance of closest point of approach of vessels at position1 and position2 "
+      "moving with velocities as vectors of course and speed in m/s. Times of past approaches are negative",
+      release_gil);
+  m.def("cpa_batch", &cpa_batch,
+      "latitude1"_a, "longitude1"_a, "course1"_a, "speed1"_a, "latitude2"_a, "longitude2"_a, "course2"_a, "speed2"_a,
+      "out"_a = py::none(), "threads"_a = 0, "ellipsoid"_a = py::none(),
+      "Array version of cpa with courses and speeds in m/s. Arguments are broadcast against each other. "
+      "Returns array with trailing dimension of 2: time and distance of closest point of approach");
+  m.def("intersection", &intersection, "start1"_a, "end1"_a, "start2"_a, "end2"_a, "kind"_a = "ortho",
+      "ellipsoid"_a = py::none(),
+      "Get intersection of the orthodrome (\"ortho\") or loxodrome (\"loxo\") segments from start1 to end1 "
+      "and from start2 to end2, or None when they don't intersect",
+      release_gil);
+  m.def("route_intersections", &route_intersections, "route"_a, "segments"_a, "kind"_a = "ortho",
+      "threads"_a = 0, "ellipsoid"_a = py::none(),
+      "Find intersections of the legs of route, a PositionArray or (N, 2) array, with (M, 4) array of segments "
+      "as start latitude, start longitude, end latitude, end longitude. Returns arrays of leg indices, segment "
+      "indices and (K, 2) array of intersection positions, ordered by leg");
 }
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace geofun {
+
+static constexpr double pi = 3.14159265358979323846;
+static constexpr double r2d = 180.0 / pi;
+static constexpr double d2r = pi / 180.0;
+
+
+inline double angle_mod(const double angle) {
+  double result = std::fmod(angle, 360.0);
+  return result < 0.0 ? result + 360.0 : result;
+}
+
+
+inline double angle_mod_signed(const double angle) {
+  double result = std::fmod(angle, 360.0);
+  return result < -180.0 ? result + 360.0 : result >= 180.0 ? result - 360.0 : result;
+}
+
+
+inline double angle_diff(const double angle1, const double angle2) {
+  return angle_mod_signed(angle1 - angle2);
+}
+
+
+/**
+ * Bound size angles in place to [0, 360>, with the same results as
+ * angle_mod. Uses AVX-512 or AVX2 when the CPU has them. Float angles are
+ * reduced in single precision.
+ */
+void angle_mod_array(double* angles, const std::ptrdiff_t size, const int threads);
+void angle_mod_array(float* angles, const std::ptrdiff_t size, const int threads);
+
+
+/**
+ * Bound size angles in place to [-180, 180>, with the same results as
+ * angle_mod_signed
+ */
+void angle_mod_signed_array(double* angles, const std::ptrdiff_t size, const int threads);
+void angle_mod_signed_array(float* angles, const std::ptrdiff_t size, const int threads);
+
+
+/**
+ * Normalize size positions in place like the Position setters do: latitudes
+ * beyond the poles are folded back and longitudes are bound to [-180, 180>
+ */
+void normalize_positions(double* latitudes, double* longitudes, const std::ptrdiff_t size, const int threads);
+void normalize_positions(float* latitudes, float* longitudes, const std::ptrdiff_t size, const int threads);
+
+
+inline bool floats_equal(const double value1, const double value2)
+{
+  double abs1 = std::fabs(value1);
+  double abs2 = std::fabs(value2);
+  double absmax = std::max(abs1, abs2);
+  double eps = 1E-13;
+  // Get relative eps value except for values very close to zero
+  if (absmax > 1E-7) {
+    eps *= absmax;
+  }
+  return std::fabs(value1 - value2) < eps;
+}
+
+
+inline bool float_smaller(const double value1, const double value2)
+{
+  return value1 < value2 and not floats_equal(value1, value2);
+}
+
+}  // namespace geofun
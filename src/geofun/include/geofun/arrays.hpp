@@ -0,0 +1,434 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include <geofun/parallel.hpp>
+#include <geofun/primitives.hpp>
+
+namespace geofun {
+
+/**
+ * Get the size of the result of combining arrays of size1 and size2, where
+ * arrays of size 1 are repeated
+ */
+size_t broadcast_size(const size_t size1, const size_t size2);
+
+
+/**
+ * Get index i, which counts from the end when negative, checked against size
+ */
+size_t checked_index(int i, const size_t size, const char* name);
+
+
+/**
+ * Array of vectors, stored as a structure of arrays: all azimuths followed by
+ * all lengths in a single contiguous buffer
+ */
+struct VectorArray {
+  VectorArray() = default;
+  VectorArray(const VectorArray&) = default;
+  VectorArray(VectorArray&&) = default;
+  explicit VectorArray(const size_t size): size_(size), values_(2 * size, 0.0) {}
+  explicit VectorArray(const Vector& vector): VectorArray(1) {
+    set(0, vector);
+  }
+  VectorArray(const double* azimuths, const double* lengths, const size_t size): VectorArray(size) {
+    for (size_t i = 0; i < size_; ++i) {
+      set(i, Vector(azimuths[i], lengths[i]));
+    }
+  }
+  /**
+   * Construct from size pairs of azimuth and length
+   */
+  VectorArray(const double* values, const size_t size): VectorArray(size) {
+    const double* value = values;
+    for (size_t i = 0; i < size_; ++i, value += 2) {
+      set(i, Vector(value[0], value[1]));
+    }
+  }
+  VectorArray(const std::vector<Vector>& vectors): VectorArray(vectors.size()) {
+    for (size_t i = 0; i < size_; ++i) {
+      set(i, vectors[i]);
+    }
+  }
+  VectorArray& operator=(const VectorArray&) = default;
+  VectorArray& operator=(VectorArray&&) = default;
+
+  size_t size() const {
+    return size_;
+  }
+
+  const double* azimuths() const {
+    return values_.data();
+  }
+
+  double* azimuths() {
+    return values_.data();
+  }
+
+  const double* lengths() const {
+    return values_.data() + size_;
+  }
+
+  double* lengths() {
+    return values_.data() + size_;
+  }
+
+  Vector get(const size_t i) const {
+    Vector result;
+    result.azimuth_ = azimuths()[i];
+    result.length_ = lengths()[i];
+    return result;
+  }
+
+  VectorArray& set(const size_t i, const Vector& vector) {
+    azimuths()[i] = vector.get_azimuth();
+    lengths()[i] = vector.get_length();
+    return *this;
+  }
+
+  Vector get_item(const int i) const {
+    return get(checked_index(i, size_, "VectorArray"));
+  }
+
+  VectorArray& set_item(const int i, const Vector& vector) {
+    return set(checked_index(i, size_, "VectorArray"), vector);
+  }
+
+  int get_len() const {
+    return static_cast<int>(size_);
+  }
+
+  std::string get_representation() const {
+    return fmt::format("VectorArray({} vectors)", size_);
+  }
+
+  bool operator==(const VectorArray& vectors) const {
+    if (size_ != vectors.size_) {
+      return false;
+    }
+    for (size_t i = 0; i < size_; ++i) {
+      if (!(get(i) == vectors.get(i))) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  VectorArray& operator+=(const VectorArray& vectors) {
+    return apply(vectors, [](const Vector& vector1, const Vector& vector2) { return vector1 + vector2; });
+  }
+
+  VectorArray& operator-=(const VectorArray& vectors) {
+    return apply(vectors, [](const Vector& vector1, const Vector& vector2) { return vector1 - vector2; });
+  }
+
+  VectorArray& operator*=(const double multiplier) {
+    return transform([multiplier](const Vector& vector) { return vector * multiplier; });
+  }
+
+  VectorArray& operator/=(const double divider) {
+    return transform([divider](const Vector& vector) { return vector / divider; });
+  }
+
+  /**
+   * Rotate the vectors by angle degrees, like Vector does
+   */
+  VectorArray& operator+=(const double angle) {
+    return transform([angle](const Vector& vector) { return vector + angle; });
+  }
+
+  VectorArray& operator-=(const double angle) {
+    return transform([angle](const Vector& vector) { return vector - angle; });
+  }
+
+  VectorArray operator+(const VectorArray& vectors) const {
+    VectorArray result(*this);
+    result += vectors;
+    return result;
+  }
+
+  VectorArray operator-(const VectorArray& vectors) const {
+    VectorArray result(*this);
+    result -= vectors;
+    return result;
+  }
+
+  VectorArray operator*(const double multiplier) const {
+    VectorArray result(*this);
+    result *= multiplier;
+    return result;
+  }
+
+  VectorArray operator/(const double divider) const {
+    VectorArray result(*this);
+    result /= divider;
+    return result;
+  }
+
+  VectorArray operator+(const double angle) const {
+    VectorArray result(*this);
+    result += angle;
+    return result;
+  }
+
+  VectorArray operator-(const double angle) const {
+    VectorArray result(*this);
+    result -= angle;
+    return result;
+  }
+
+  VectorArray operator-() const {
+    VectorArray result(*this);
+    return result.transform([](const Vector& vector) { return -vector; });
+  }
+
+private:
+  friend VectorArray operator-(const double angle, const VectorArray& vectors);
+
+  template <typename Operation>
+  VectorArray& apply(const VectorArray& vectors, Operation operation) {
+    if (broadcast_size(size_, vectors.size_) != size_) {
+      *this = VectorArray(std::vector<Vector>(vectors.size_, get(0)));
+    }
+    const size_t step = vectors.size_ == 1 ? 0 : 1;
+    parallel_for(size_, 0, [&](const std::ptrdiff_t begin, const std::ptrdiff_t end) {
+      for (std::ptrdiff_t i = begin; i < end; ++i) {
+        set(i, operation(get(i), vectors.get(i * step)));
+      }
+    });
+    return *this;
+  }
+
+  /**
+   * Replace each vector by operation(vector)
+   */
+  template <typename Operation>
+  VectorArray& transform(Operation operation) {
+    parallel_for(size_, 0, [&](const std::ptrdiff_t begin, const std::ptrdiff_t end) {
+      for (std::ptrdiff_t i = begin; i < end; ++i) {
+        set(i, operation(get(i)));
+      }
+    });
+    return *this;
+  }
+
+  size_t size_ = 0;
+  std::vector<double> values_;
+};
+
+
+VectorArray operator*(const double multiplier, const VectorArray& vectors);
+VectorArray operator+(const double angle, const VectorArray& vectors);
+VectorArray operator-(const double angle, const VectorArray& vectors);
+
+
+/**
+ * Array of positions, stored as a structure of arrays: all latitudes followed
+ * by all longitudes in a single contiguous buffer
+ */
+struct PositionArray {
+  PositionArray() = default;
+  PositionArray(const PositionArray&) = default;
+  PositionArray(PositionArray&&) = default;
+  explicit PositionArray(const size_t size): size_(size), values_(2 * size, 0.0) {}
+  explicit PositionArray(const Position& position): PositionArray(1) {
+    set(0, position);
+  }
+  /**
+   * Construct from latitudes and longitudes, normalized like Position does
+   */
+  PositionArray(const double* latitudes, const double* longitudes, const size_t size): PositionArray(size) {
+    std::copy(latitudes, latitudes + size, this->latitudes());
+    std::copy(longitudes, longitudes + size, this->longitudes());
+    normalize_positions(this->latitudes(), this->longitudes(), size_, 0);
+  }
+  /**
+   * Construct from size pairs of latitude and longitude
+   */
+  PositionArray(const double* values, const size_t size): PositionArray(size) {
+    double* latitude = latitudes();
+    double* longitude = longitudes();
+    for (size_t i = 0; i < size_; ++i) {
+      latitude[i] = values[2 * i];
+      longitude[i] = values[2 * i + 1];
+    }
+    normalize_positions(latitude, longitude, size_, 0);
+  }
+  PositionArray(const std::vector<Position>& positions): PositionArray(positions.size()) {
+    for (size_t i = 0; i < size_; ++i) {
+      set(i, positions[i]);
+    }
+  }
+  PositionArray& operator=(const PositionArray&) = default;
+  PositionArray& operator=(PositionArray&&) = default;
+
+  size_t size() const {
+    return size_;
+  }
+
+  const double* latitudes() const {
+    return values_.data();
+  }
+
+  double* latitudes() {
+    return values_.data();
+  }
+
+  const double* longitudes() const {
+    return values_.data() + size_;
+  }
+
+  double* longitudes() {
+    return values_.data() + size_;
+  }
+
+  double latitude(const size_t i) const {
+    return values_[i];
+  }
+
+  double longitude(const size_t i) const {
+    return values_[size_ + i];
+  }
+
+  Position get(const size_t i) const {
+    Position result;
+    result.latitude_ = latitudes()[i];
+    result.longitude_ = longitudes()[i];
+    return result;
+  }
+
+  PositionArray& set(const size_t i, const Position& position) {
+    latitudes()[i] = position.get_latitude();
+    longitudes()[i] = position.get_longitude();
+    return *this;
+  }
+
+  Position get_item(const int i) const {
+    return get(checked_index(i, size_, "PositionArray"));
+  }
+
+  PositionArray& set_item(const int i, const Position& position) {
+    return set(checked_index(i, size_, "PositionArray"), position);
+  }
+
+  int get_len() const {
+    return static_cast<int>(size_);
+  }
+
+  std::string get_representation() const {
+    return fmt::format("PositionArray({} positions)", size_);
+  }
+
+  PositionArray& operator+=(const VectorArray& vectors);
+  PositionArray& operator-=(const VectorArray& vectors);
+  PositionArray& operator*=(const VectorArray& vectors);
+  PositionArray& operator/=(const VectorArray& vectors);
+
+  PositionArray operator+(const VectorArray& vectors) const {
+    PositionArray result(*this);
+    result += vectors;
+    return result;
+  }
+
+  PositionArray operator-(const VectorArray& vectors) const {
+    PositionArray result(*this);
+    result -= vectors;
+    return result;
+  }
+
+  PositionArray operator*(const VectorArray& vectors) const {
+    PositionArray result(*this);
+    result *= vectors;
+    return result;
+  }
+
+  PositionArray operator/(const VectorArray& vectors) const {
+    PositionArray result(*this);
+    result /= vectors;
+    return result;
+  }
+
+  PositionArray& operator+=(const Vector& vector) {
+    return operator+=(VectorArray(vector));
+  }
+
+  PositionArray& operator-=(const Vector& vector) {
+    return operator-=(VectorArray(vector));
+  }
+
+  PositionArray& operator*=(const Vector& vector) {
+    return operator*=(VectorArray(vector));
+  }
+
+  PositionArray& operator/=(const Vector& vector) {
+    return operator/=(VectorArray(vector));
+  }
+
+  PositionArray operator+(const Vector& vector) const {
+    return operator+(VectorArray(vector));
+  }
+
+  PositionArray operator-(const Vector& vector) const {
+    return operator-(VectorArray(vector));
+  }
+
+  PositionArray operator*(const Vector& vector) const {
+    return operator*(VectorArray(vector));
+  }
+
+  PositionArray operator/(const Vector& vector) const {
+    return operator/(VectorArray(vector));
+  }
+
+private:
+  /**
+   * Offset positions by vectors using direct solver kernel(latitude, longitude, azimuth, distance,
+   * out_latitude, out_longitude) with distances multiplied by sign
+   */
+  template <typename Kernel>
+  PositionArray& offset(const VectorArray& vectors, const double sign, Kernel kernel) {
+    if (broadcast_size(size_, vectors.size()) != size_) {
+      *this = PositionArray(std::vector<Position>(vectors.size(), get(0)));
+    }
+    const size_t step = vectors.size() == 1 ? 0 : 1;
+    double* latitude = latitudes();
+    double* longitude = longitudes();
+    const double* azimuth = vectors.azimuths();
+    const double* length = vectors.lengths();
+    parallel_for(size_, 0, [&](const std::ptrdiff_t begin, const std::ptrdiff_t end) {
+      for (std::ptrdiff_t i = begin; i < end; ++i) {
+        kernel(latitude[i], longitude[i], azimuth[i * step], sign * length[i * step], latitude[i], longitude[i]);
+      }
+    });
+    return *this;
+  }
+
+  size_t size_ = 0;
+  std::vector<double> values_;
+};
+
+
+/**
+ * Get rhumb line vectors from positions1 to positions2
+ */
+VectorArray operator-(const PositionArray& positions2, const PositionArray& positions1);
+
+
+/**
+ * Get geodesic vectors from positions1 to positions2
+ */
+VectorArray operator/(const PositionArray& positions2, const PositionArray& positions1);
+
+
+VectorArray operator-(const PositionArray& positions2, const Position& position1);
+VectorArray operator-(const Position& position2, const PositionArray& positions1);
+VectorArray operator/(const PositionArray& positions2, const Position& position1);
+VectorArray operator/(const Position& position2, const PositionArray& positions1);
+
+}  // namespace geofun
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include <GeographicLib/Geodesic.hpp>
+
+#include <geofun/angles.hpp>
+#include <geofun/primitives.hpp>
+
+namespace geofun {
+
+/**
+ * Approximations of the geodesic distance between positions that are cheaper
+ * than solving the inverse geodesic problem
+ */
+struct ApproximateDistance {
+  explicit ApproximateDistance(const gl::Geodesic& geodesic): geodesic(geodesic) {
+    const double a = geodesic.EquatorialRadius();
+    const double f = geodesic.Flattening();
+    equatorial_radius = a;
+    flattening = f;
+    eccentricity_squared = f * (2.0 - f);
+    mean_radius = a * (1.0 - f / 3.0);
+    // Minimum and maximum radius of curvature, at the equator and the poles
+    min_radius = a * (1.0 - f) * (1.0 - f);
+    max_radius = a / (1.0 - f);
+  }
+
+  /**
+   * Angle in radians between positions on a sphere
+   */
+  static double central_angle(
+      const double latitude1, const double longitude1,
+      const double latitude2, const double longitude2) {
+    const double sin_latitude = std::sin(0.5 * d2r * (latitude2 - latitude1));
+    const double sin_longitude = std::sin(0.5 * d2r * (longitude2 - longitude1));
+    const double h = sin_latitude * sin_latitude
+        + std::cos(d2r * latitude1) * std::cos(d2r * latitude2) * sin_longitude * sin_longitude;
+    return 2.0 * std::asin(std::sqrt(std::min(h, 1.0)));
+  }
+
+  /**
+   * Great circle distance on a sphere with the mean radius. Off by up to 0.6%.
+   */
+  double haversine(
+      const double latitude1, const double longitude1,
+      const double latitude2, const double longitude2) const {
+    return mean_radius * central_angle(latitude1, longitude1, latitude2, longitude2);
+  }
+
+  /**
+   * Distance on the local flat plane at the mean latitude, using the radii
+   * of curvature of the ellipsoid. Off by less than 0.1% up to 100 km below
+   * 80 degrees latitude and growing quadratically with the distance.
+   */
+  double equirectangular(
+      const double latitude1, const double longitude1,
+      const double latitude2, const double longitude2) const {
+    const double latitude = 0.5 * d2r * (latitude1 + latitude2);
+    const double sin_latitude = std::sin(latitude);
+    const double w2 = 1.0 - eccentricity_squared * sin_latitude * sin_latitude;
+    const double normal_radius = equatorial_radius / std::sqrt(w2);
+    const double meridional_radius = normal_radius * (1.0 - eccentricity_squared) / w2;
+    const Point point(
+        meridional_radius * d2r * (latitude2 - latitude1),
+        normal_radius * std::cos(latitude) * d2r * angle_mod_signed(longitude2 - longitude1));
+    return std::hypot(point.get_x(), point.get_y());
+  }
+
+  /**
+   * Lambert's first order flattening correction to the great circle distance
+   * between reduced latitudes. Off by less than 0.01% and typically about
+   * 10 m over thousands of kilometers. Nearly antipodal positions, where the
+   * correction breaks down, are solved exactly.
+   */
+  double andoyer_lambert(
+      const double latitude1, const double longitude1,
+      const double latitude2, const double longitude2) const {
+    const double reduced1 = std::atan((1.0 - flattening) * std::tan(d2r * latitude1)) / d2r;
+    const double reduced2 = std::atan((1.0 - flattening) * std::tan(d2r * latitude2)) / d2r;
+    const double sigma = central_angle(reduced1, longitude1, reduced2, longitude2);
+    if (sigma < 1E-12) {
+      return equatorial_radius * sigma;
+    }
+    if (sigma > pi - 1E-2) {
+      double distance;
+      geodesic.Inverse(latitude1, longitude1, latitude2, longitude2, distance);
+      return distance;
+    }
+    const double p = 0.5 * d2r * (reduced1 + reduced2);
+    const double q = 0.5 * d2r * (reduced2 - reduced1);
+    const double sin_p = std::sin(p);
+    const double cos_p = std::cos(p);
+    const double sin_q = std::sin(q);
+    const double cos_q = std::cos(q);
+    const double sin_half = std::sin(0.5 * sigma);
+    const double cos_half = std::cos(0.5 * sigma);
+    const double x = (sigma - std::sin(sigma)) * sin_p * sin_p * cos_q * cos_q / (cos_half * cos_half);
+    const double y = (sigma + std::sin(sigma)) * cos_p * cos_p * sin_q * sin_q / (sin_half * sin_half);
+    return equatorial_radius * (sigma - 0.5 * flattening * (x + y));
+  }
+
+  /**
+   * Check whether the geodesic distance between positions is at most radius.
+   * The central angle bounds the distance between min_radius and max_radius
+   * times the angle, so the exact distance is only needed near radius.
+   */
+  bool within(
+      const double latitude1, const double longitude1,
+      const double latitude2, const double longitude2, const double radius) const {
+    const double sigma = central_angle(latitude1, longitude1, latitude2, longitude2);
+    // Margins guard the bounds against rounding
+    if (max_radius * sigma * (1.0 + 1E-12) <= radius) {
+      return true;
+    }
+    if (min_radius * sigma * (1.0 - 1E-12) > radius) {
+      return false;
+    }
+    double distance;
+    geodesic.Inverse(latitude1, longitude1, latitude2, longitude2, distance);
+    return distance <= radius;
+  }
+
+  const gl::Geodesic& geodesic;
+  double equatorial_radius;
+  double flattening;
+  double eccentricity_squared;
+  double mean_radius;
+  double min_radius;
+  double max_radius;
+};
+
+
+enum class Metric {
+  geodesic,
+  rhumb,
+  haversine
+};
+
+
+Metric get_metric(const std::string& name);
+
+
+/**
+ * Get metric for legs, which need azimuths as well as distances
+ */
+Metric get_leg_metric(const std::string& name);
+
+}  // namespace geofun
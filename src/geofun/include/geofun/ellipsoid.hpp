@@ -0,0 +1,163 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <tuple>
+
+#include <GeographicLib/Geodesic.hpp>
+#include <GeographicLib/Rhumb.hpp>
+
+namespace geofun {
+
+namespace gl = GeographicLib;
+
+
+/**
+ * Ellipsoid of revolution with geodesic and rhumb line calculations on it.
+ * Rhumb objects are expensive to construct, so they are shared between
+ * ellipsoids with the same parameters through a cache.
+ */
+class Ellipsoid {
+public:
+  Ellipsoid(const double equatorial_radius, const double flattening):
+      geodesic_(equatorial_radius, flattening),
+      rhumb_(get_rhumb(equatorial_radius, flattening)) {}
+
+  const gl::Geodesic& geodesic() const {
+    return geodesic_;
+  }
+
+  const gl::Rhumb& rhumb() const {
+    return *rhumb_;
+  }
+
+  double get_equatorial_radius() const {
+    return geodesic_.EquatorialRadius();
+  }
+
+  double get_flattening() const {
+    return geodesic_.Flattening();
+  }
+
+  /**
+   * Signed first eccentricity, like GeographicLib uses: negative for prolate
+   * ellipsoids, whose squared eccentricity f(2 - f) is negative, so their
+   * eccentricity is imaginary with this magnitude
+   */
+  double get_eccentricity() const {
+    const double squared = get_flattening() * (2.0 - get_flattening());
+    return squared < 0.0 ? -std::sqrt(-squared) : std::sqrt(squared);
+  }
+
+  bool operator==(const Ellipsoid& other) const {
+    return get_equatorial_radius() == other.get_equatorial_radius() && get_flattening() == other.get_flattening();
+  }
+
+  std::string get_representation() const;
+
+private:
+  static std::shared_ptr<const gl::Rhumb> get_rhumb(const double equatorial_radius, const double flattening);
+
+  gl::Geodesic geodesic_;
+  std::shared_ptr<const gl::Rhumb> rhumb_;
+};
+
+
+/**
+ * Default ellipsoid, used when no ellipsoid is passed. It is constructed on
+ * first use, so it is safe to use during static initialization.
+ */
+const Ellipsoid& get_wgs84();
+
+
+inline const Ellipsoid& get_ellipsoid(const Ellipsoid* ellipsoid) {
+  return ellipsoid ? *ellipsoid : get_wgs84();
+}
+
+
+/**
+ * Outputs of the inverse kernels, combined into the mask they are
+ * instantiated with
+ */
+enum Output : unsigned {
+  output_distance = 1U << 0,
+  output_azimuth = 1U << 1,
+  output_final_azimuth = 1U << 2,
+  output_all = output_distance | output_azimuth | output_final_azimuth
+};
+
+
+/**
+ * Solve the inverse geodesic problem, asking GeographicLib only for the
+ * outputs in Mask. Either azimuth makes it compute both, other outputs are
+ * left unset.
+ */
+template <unsigned Mask>
+inline void geodesic_inverse_kernel(const gl::Geodesic& geodesic,
+    const double latitude1, const double longitude1, const double latitude2, const double longitude2,
+    double& distance, double& azimuth1, double& azimuth2) {
+  static_assert(Mask != 0 && (Mask & ~output_all) == 0, "Invalid output mask");
+  constexpr unsigned outmask = (Mask & output_distance ? static_cast<unsigned>(gl::Geodesic::DISTANCE) : 0U)
+      | (Mask & (output_azimuth | output_final_azimuth) ? static_cast<unsigned>(gl::Geodesic::AZIMUTH) : 0U);
+  double reduced_length;
+  double scale12;
+  double scale21;
+  double area;
+  geodesic.GenInverse(latitude1, longitude1, latitude2, longitude2, outmask,
+      distance, azimuth1, azimuth2, reduced_length, scale12, scale21, area);
+}
+
+
+/**
+ * Solve the inverse rhumb line problem, asking GeographicLib only for the
+ * outputs in Mask. The final azimuth of a rhumb line is its azimuth.
+ */
+template <unsigned Mask>
+inline void rhumb_inverse_kernel(const gl::Rhumb& rhumb,
+    const double latitude1, const double longitude1, const double latitude2, const double longitude2,
+    double& distance, double& azimuth) {
+  static_assert(Mask != 0 && (Mask & ~output_all) == 0, "Invalid output mask");
+  constexpr unsigned outmask = (Mask & output_distance ? static_cast<unsigned>(gl::Rhumb::DISTANCE) : 0U)
+      | (Mask & (output_azimuth | output_final_azimuth) ? static_cast<unsigned>(gl::Rhumb::AZIMUTH) : 0U);
+  double area;
+  rhumb.GenInverse(latitude1, longitude1, latitude2, longitude2, outmask, distance, azimuth, area);
+}
+
+
+std::tuple<double, double, double> rhumb_direct(
+    const double latitude, const double longitude, const double azimuth, const double distance,
+    const Ellipsoid* ellipsoid);
+
+
+std::tuple<double, double, double> rhumb_inverse(
+    const double latitude1, const double longitude1, const double latitude2, const double longitude2,
+    const Ellipsoid* ellipsoid);
+
+
+std::tuple<double, double, double> geodesic_direct(
+    const double latitude, const double longitude, const double azimuth, const double distance,
+    const Ellipsoid* ellipsoid);
+
+
+std::tuple<double, double, double> geodesic_inverse(
+    const double latitude1, const double longitude1, const double latitude2, const double longitude2,
+    const Ellipsoid* ellipsoid);
+
+
+/**
+ * Get isometric latitude, the Mercator ordinate in radians, of latitude in
+ * degrees on an ellipsoid with signed eccentricity. Finite at the poles,
+ * since the tangent of 90 degrees in radians is.
+ */
+double isometric_latitude(const double latitude, const double eccentricity);
+
+
+/**
+ * Get latitude in degrees of isometric latitude. The fixed point iteration
+ * gains a factor of the squared eccentricity per step.
+ */
+double inverse_isometric_latitude(const double isometric, const double eccentricity);
+
+}  // namespace geofun
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <geofun/angles.hpp>
+#include <geofun/arrays.hpp>
+#include <geofun/distance.hpp>
+#include <geofun/ellipsoid.hpp>
+#include <geofun/grid.hpp>
+#include <geofun/index.hpp>
+#include <geofun/intersect.hpp>
+#include <geofun/lines.hpp>
+#include <geofun/parallel.hpp>
+#include <geofun/parse.hpp>
+#include <geofun/polygon.hpp>
+#include <geofun/primitives.hpp>
+#include <geofun/projection.hpp>
+#include <geofun/stats.hpp>
+#include <geofun/tracks.hpp>
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+
+namespace geofun {
+
+/**
+ * Convert position to UTM or UPS zone, hemisphere, easting and northing.
+ * Zone 0 is UPS. Returns false, with zone gl::UTMUPS::INVALID and NaN
+ * coordinates, for positions that can't be converted.
+ */
+bool utm_forward(const double latitude, const double longitude, int& zone, bool& north, double& easting,
+    double& northing);
+
+
+/**
+ * Convert UTM or UPS coordinates to position. Returns false, with NaN
+ * latitude and longitude, for invalid coordinates.
+ */
+bool utm_reverse(const int zone, const bool north, const double easting, const double northing, double& latitude,
+    double& longitude);
+
+
+void check_mgrs_precision(const int precision);
+
+
+/**
+ * Get MGRS reference of position with precision digits per coordinate, 5
+ * being 1 m. Returns false for positions that can't be converted.
+ */
+bool mgrs_forward(const double latitude, const double longitude, const int precision, std::string& code);
+
+
+/**
+ * Get the center of an MGRS square. Returns false for invalid references.
+ */
+bool mgrs_reverse(const std::string& code, double& latitude, double& longitude);
+
+
+void check_geohash_length(const int length);
+
+
+/**
+ * Get geohash of position with length characters. Returns false for NaN
+ * positions.
+ */
+bool geohash_forward(const double latitude, const double longitude, const int length, std::string& code);
+
+
+/**
+ * Get the center of a geohash cell. Returns false for invalid geohashes.
+ */
+bool geohash_reverse(const std::string& code, double& latitude, double& longitude);
+
+}  // namespace geofun
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <geofun/angles.hpp>
+#include <geofun/distance.hpp>
+#include <geofun/ellipsoid.hpp>
+
+namespace geofun {
+
+using UnitVector = std::array<double, 3>;
+
+
+UnitVector unit_vector(const double latitude, const double longitude);
+
+
+/**
+ * Angle in radians on the unit sphere that corresponds to a chord
+ */
+double chord_angle(const double chord);
+
+
+double chord_length(const UnitVector& vector1, const UnitVector& vector2);
+
+
+/**
+ * Spatial index on a set of positions for nearest neighbour and radius
+ * queries by geodesic distance. Positions are kept in a k-d tree of unit
+ * vectors. The angles between those give lower bounds for the geodesic
+ * distances, which prune the tree. Remaining candidates are refined with
+ * the exact geodesic distance.
+ */
+class PositionIndex {
+public:
+  /**
+   * Construct index on coordinates: anything with size(), latitude(i) and
+   * longitude(i)
+   */
+  template <typename Coordinates>
+  PositionIndex(const Coordinates& coordinates, const Ellipsoid& ellipsoid):
+      ellipsoid_(ellipsoid), min_radius_(ApproximateDistance(ellipsoid.geodesic()).min_radius) {
+    const std::ptrdiff_t size = coordinates.size();
+    latitudes_.resize(size);
+    longitudes_.resize(size);
+    for (std::ptrdiff_t i = 0; i < size; ++i) {
+      latitudes_[i] = coordinates.latitude(i);
+      longitudes_[i] = coordinates.longitude(i);
+    }
+    build_tree();
+  }
+
+  std::ptrdiff_t size() const {
+    return static_cast<std::ptrdiff_t>(indices_.size());
+  }
+
+  /**
+   * Find the count nearest positions to latitude, longitude. Writes the
+   * indices and distances in order of increasing distance and pads with -1
+   * and infinity when the index holds fewer positions.
+   */
+  void nearest(const double latitude, const double longitude, const std::ptrdiff_t count,
+      int64_t* indices, double* distances) const;
+
+  /**
+   * Find all positions within radius of latitude, longitude. Appends pairs of
+   * distance and index to result in order of increasing distance.
+   */
+  void within(const double latitude, const double longitude, const double radius,
+      std::vector<std::pair<double, int64_t>>& result) const;
+
+private:
+  static constexpr std::ptrdiff_t leaf_size = 16;
+  static constexpr double inf = std::numeric_limits<double>::infinity();
+  // Guards the lower bounds against rounding
+  static constexpr double bound_margin = 1.0 - 1E-12;
+
+  struct Node {
+    UnitVector min;
+    UnitVector max;
+    std::ptrdiff_t begin;
+    std::ptrdiff_t end;
+    int left;
+    int right;
+  };
+
+  /**
+   * Build the k-d tree on the positions and store them in tree order
+   */
+  void build_tree();
+
+  int build(std::vector<std::ptrdiff_t>& order, const std::ptrdiff_t begin, const std::ptrdiff_t end);
+
+  double lower_bound(const Node& node, const UnitVector& point) const {
+    double squared = 0.0;
+    for (int d = 0; d < 3; ++d) {
+      const double excess = std::max({0.0, node.min[d] - point[d], point[d] - node.max[d]});
+      squared += excess * excess;
+    }
+    return bound_margin * min_radius_ * chord_angle(std::sqrt(squared));
+  }
+
+  double lower_bound(const std::ptrdiff_t i, const UnitVector& point) const {
+    return bound_margin * min_radius_ * chord_angle(chord_length(points_[i], point));
+  }
+
+  double geodesic_distance(const std::ptrdiff_t i, const double latitude, const double longitude) const {
+    double distance;
+    ellipsoid_.geodesic().Inverse(latitude, longitude, latitudes_[i], longitudes_[i], distance);
+    return distance;
+  }
+
+  Ellipsoid ellipsoid_;
+  double min_radius_;
+  std::vector<Node> nodes_;
+  std::vector<int64_t> indices_;
+  std::vector<double> latitudes_;
+  std::vector<double> longitudes_;
+  std::vector<UnitVector> points_;
+};
+
+}  // namespace geofun
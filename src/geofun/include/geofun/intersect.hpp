@@ -0,0 +1,80 @@
+#pragma once
+
+#include <optional>
+#include <string>
+
+#include <GeographicLib/Geodesic.hpp>
+#include <GeographicLib/Intersect.hpp>
+
+#include <geofun/ellipsoid.hpp>
+#include <geofun/lines.hpp>
+#include <geofun/primitives.hpp>
+
+namespace geofun {
+
+/**
+ * Latitude and longitude bounds of a segment. East may exceed 180 degrees
+ * for boxes crossing the antimeridian.
+ */
+struct Box {
+  double south;
+  double north;
+  double west;
+  double east;
+
+  bool overlaps(const Box& other) const {
+    if (south > other.north || other.south > north) {
+      return false;
+    }
+    for (const double shift: {-360.0, 0.0, 360.0}) {
+      if (other.west + shift <= east && west <= other.east + shift) {
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+
+/**
+ * Intersection of orthodrome or loxodrome segments. Orthodromes are solved
+ * with gl::Intersect. Loxodromes are straight lines in longitude and
+ * isometric latitude, where the intersection is that of two line segments.
+ */
+class SegmentIntersector {
+public:
+  SegmentIntersector(const Ellipsoid& ellipsoid, const LineKind kind):
+      geodesic_(ellipsoid.geodesic()), intersect_(ellipsoid.geodesic()), kind_(kind),
+      eccentricity_(ellipsoid.get_eccentricity()) {}
+
+  /**
+   * Get the bounds of a segment. Longitude is monotonic along both kinds of
+   * segments and so is latitude along loxodromes, but orthodromes can pass
+   * their vertex, the point closest to a pole.
+   */
+  Box get_box(const double latitude1, const double longitude1, const double latitude2, const double longitude2) const;
+
+  /**
+   * Find intersection of the segments from position 1 to 2 and from position
+   * 3 to 4. Returns false when they don't intersect.
+   */
+  bool intersection(const double latitude1, const double longitude1, const double latitude2, const double longitude2,
+      const double latitude3, const double longitude3, const double latitude4, const double longitude4,
+      double& latitude, double& longitude) const;
+
+private:
+  const gl::Geodesic& geodesic_;
+  gl::Intersect intersect_;
+  LineKind kind_;
+  double eccentricity_;
+};
+
+
+/**
+ * Find intersection of the segments from start1 to end1 and from start2 to
+ * end2 with orthodrome or loxodrome edges
+ */
+std::optional<Position> intersection(const Position& start1, const Position& end1, const Position& start2,
+    const Position& end2, const std::string& kind, const Ellipsoid* ellipsoid);
+
+}  // namespace geofun
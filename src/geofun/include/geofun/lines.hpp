@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <GeographicLib/Geodesic.hpp>
+#include <GeographicLib/GeodesicLine.hpp>
+#include <GeographicLib/Rhumb.hpp>
+
+#include <geofun/angles.hpp>
+#include <geofun/ellipsoid.hpp>
+#include <geofun/primitives.hpp>
+
+namespace geofun {
+
+gl::GeodesicLine ortho_line(const Vector& vector, const Position& start, const Ellipsoid& ellipsoid);
+
+
+gl::RhumbLine loxo_line(const Vector& vector, const Position& start, const Ellipsoid& ellipsoid);
+
+
+static constexpr unsigned ortho_line_caps =
+    gl::Geodesic::LATITUDE | gl::Geodesic::LONGITUDE | gl::Geodesic::AZIMUTH | gl::Geodesic::DISTANCE_IN;
+
+
+/**
+ * Geodesic line with azimuths along it, for finding intercepts
+ */
+struct OrthoLine {
+  explicit OrthoLine(const gl::GeodesicLine& line): line(line) {}
+
+  void position(const double distance, double& latitude, double& longitude, double& azimuth) const {
+    line.Position(distance, latitude, longitude, azimuth);
+  }
+
+  gl::GeodesicLine line;
+};
+
+
+/**
+ * Rhumb line with its constant azimuth, for finding intercepts
+ */
+struct LoxoLine {
+  explicit LoxoLine(const gl::RhumbLine& line): line(line) {}
+
+  void position(const double distance, double& latitude, double& longitude, double& azimuth) const {
+    line.Position(distance, latitude, longitude);
+    azimuth = line.Azimuth();
+  }
+
+  gl::RhumbLine line;
+};
+
+
+/**
+ * Point on a line closest to a position, as distance along the line and
+ * signed distance across it, positive to the right of the line
+ */
+struct Intercept {
+  double along;
+  double cross;
+};
+
+
+/**
+ * Find the point on line closest to a position: where the geodesic to the
+ * position is perpendicular to the line. Starting at along, each iteration
+ * moves along the line by the along track distance of the position on a
+ * sphere with the mean radius, which converges in a few iterations.
+ */
+template <typename Line>
+Intercept intercept(const Line& line, const gl::Geodesic& geodesic,
+    const double latitude, const double longitude, double along = 0.0) {
+  static constexpr int max_iterations = 20;
+  static constexpr double tolerance = 1E-4;
+  const double radius = geodesic.EquatorialRadius() * (1.0 - geodesic.Flattening() / 3.0);
+  for (int i = 0; ; ++i) {
+    double line_latitude;
+    double line_longitude;
+    double line_azimuth;
+    line.position(along, line_latitude, line_longitude, line_azimuth);
+    double distance;
+    double azimuth1;
+    double azimuth2;
+    geodesic.Inverse(line_latitude, line_longitude, latitude, longitude, distance, azimuth1, azimuth2);
+    const double angle = d2r * (azimuth1 - line_azimuth);
+    const double sigma = distance / radius;
+    const double step = radius * std::atan2(std::sin(sigma) * std::cos(angle), std::cos(sigma));
+    if (std::fabs(step) < tolerance || i + 1 == max_iterations) {
+      return {along, std::sin(angle) < 0.0 ? -distance : distance};
+    }
+    along += step;
+  }
+}
+
+
+enum class LineKind {
+  ortho,
+  loxo
+};
+
+
+LineKind get_line_kind(const std::string& name);
+
+
+/**
+ * Get intercept of a position on the orthodrome or loxodrome from start to end
+ */
+Intercept line_intercept(const Ellipsoid& ellipsoid, const LineKind kind,
+    const double start_latitude, const double start_longitude, const double end_latitude, const double end_longitude,
+    const double latitude, const double longitude);
+
+
+/**
+ * Get cross track distance, positive to the right, and along track distance
+ * of position relative to the orthodrome or loxodrome of kind from start to end
+ */
+std::tuple<double, double> cross_track(const Position& start, const Position& end, const Position& position,
+    const std::string& kind, const Ellipsoid* ellipsoid);
+
+
+/**
+ * Get time and distance of the closest point of approach of two vessels at
+ * constant course and speed. The relative position and velocity are taken in
+ * the plane tangent at the first vessel, with the geodesic to the second
+ * vessel as relative position and the course of the second vessel carried
+ * along that geodesic. Times are negative when the closest point of approach
+ * is past. Vessels without relative motion have time 0.
+ */
+std::tuple<double, double> closest_approach(const gl::Geodesic& geodesic,
+    const double latitude1, const double longitude1, const double course1, const double speed1,
+    const double latitude2, const double longitude2, const double course2, const double speed2);
+
+
+/**
+ * Get time and distance of the closest point of approach of vessels at
+ * position1 and position2 moving with velocities of course and speed in m/s
+ */
+std::tuple<double, double> cpa(const Position& position1, const Vector& velocity1,
+    const Position& position2, const Vector& velocity2, const Ellipsoid* ellipsoid);
+
+
+/**
+ * Get distance of a position to the geodesic segment of length along line
+ */
+double segment_distance(const OrthoLine& line, const double length, const gl::Geodesic& geodesic,
+    const double latitude, const double longitude, double& along);
+
+
+/**
+ * Simplify the track in records begin to end with the Douglas-Peucker
+ * algorithm, using the distance to geodesic segments between kept records.
+ * Appends the indices of the kept records to kept.
+ */
+void simplify_track(const double* latitude, const double* longitude, const std::ptrdiff_t begin, const std::ptrdiff_t end,
+    const double tolerance, const gl::Geodesic& geodesic, std::vector<int64_t>& kept);
+
+
+/**
+ * Simplify the tracks in size records, keeping every record within tolerance
+ * meters of the simplified track. Records of a track are consecutive; when
+ * ids isn't null, each change of id starts a new track. Returns the indices
+ * of the kept records.
+ */
+std::vector<int64_t> simplify_tracks(const double* latitude, const double* longitude, const std::ptrdiff_t size,
+    const double tolerance, const int64_t* id, const int threads, const Ellipsoid& ellipsoid);
+
+}  // namespace geofun
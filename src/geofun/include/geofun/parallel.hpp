@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+
+namespace geofun {
+
+/**
+ * Get the number of threads used by batch operations when not specified per
+ * call
+ */
+int get_threads();
+
+
+/**
+ * Set the number of threads used by batch operations. Zero means one thread
+ * per hardware core.
+ */
+void set_threads(const int threads);
+
+
+/**
+ * Call task on the calling thread and on threads - 1 threads of a persistent
+ * pool, returning when all calls are done. The pool starts threads lazily,
+ * as calls need them, and keeps them for later calls. Pool threads that are
+ * busy with other calls when the calling thread is done are skipped, so task
+ * should share its work between the calls itself. Calls from pool threads
+ * run task on the calling thread only.
+ */
+void run_on_threads(const int threads, const std::function<void()>& task);
+
+
+/**
+ * Call function(begin, end) for chunks of the range [0, size), distributing
+ * the chunks over a number of threads. The calling thread takes part in the
+ * work. Ranges up to min_chunk_size are processed on the calling thread only.
+ */
+template <typename Function>
+void parallel_for(const std::ptrdiff_t size, int threads, Function function, const std::ptrdiff_t min_chunk_size = 1024) {
+  if (threads <= 0) {
+    threads = get_threads();
+  }
+  std::ptrdiff_t max_threads = (size + min_chunk_size - 1) / min_chunk_size;
+  threads = static_cast<int>(std::min(static_cast<std::ptrdiff_t>(threads), max_threads));
+  if (threads <= 1) {
+    function(std::ptrdiff_t(0), size);
+    return;
+  }
+  // Hand out several chunks per thread, so threads that get cheap work pick
+  // up the slack of the others
+  const std::ptrdiff_t chunk_size = std::max(min_chunk_size, size / (8 * threads));
+  std::atomic<std::ptrdiff_t> next{0};
+  std::exception_ptr error;
+  std::atomic<bool> failed{false};
+  auto worker = [&]() {
+    try {
+      std::ptrdiff_t begin;
+      while (!failed && (begin = next.fetch_add(chunk_size)) < size) {
+        function(begin, std::min(begin + chunk_size, size));
+      }
+    }
+    catch (...) {
+      if (!failed.exchange(true)) {
+        error = std::current_exception();
+      }
+    }
+  };
+  run_on_threads(threads, worker);
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+
+/**
+ * Fill rows x columns matrix with kernel(row, column), walking it in tiles
+ * that are distributed over threads. For symmetric matrices, only the upper
+ * triangle is evaluated and mirrored and the diagonal is zero.
+ */
+template <typename Kernel>
+void fill_matrix(double* values, const std::ptrdiff_t rows, const std::ptrdiff_t columns,
+    const bool symmetric, const int threads, Kernel kernel) {
+  static constexpr std::ptrdiff_t tile_size = 64;
+  const std::ptrdiff_t row_tiles = (rows + tile_size - 1) / tile_size;
+  const std::ptrdiff_t column_tiles = (columns + tile_size - 1) / tile_size;
+  parallel_for(row_tiles * column_tiles, threads, [&](const std::ptrdiff_t begin, const std::ptrdiff_t end) {
+    for (std::ptrdiff_t tile = begin; tile < end; ++tile) {
+      const std::ptrdiff_t row_tile = tile / column_tiles;
+      const std::ptrdiff_t column_tile = tile % column_tiles;
+      if (symmetric && column_tile < row_tile) {
+        continue;
+      }
+      const std::ptrdiff_t row_end = std::min(rows, (row_tile + 1) * tile_size);
+      const std::ptrdiff_t column_end = std::min(columns, (column_tile + 1) * tile_size);
+      for (std::ptrdiff_t i = row_tile * tile_size; i < row_end; ++i) {
+        std::ptrdiff_t j = column_tile * tile_size;
+        if (symmetric) {
+          if (j <= i) {
+            values[i * columns + i] = 0.0;
+            j = i + 1;
+          }
+          for (; j < column_end; ++j) {
+            values[i * columns + j] = values[j * columns + i] = kernel(i, j);
+          }
+        }
+        else {
+          for (; j < column_end; ++j) {
+            values[i * columns + j] = kernel(i, j);
+          }
+        }
+      }
+    }
+  }, 1);
+}
+
+}  // namespace geofun
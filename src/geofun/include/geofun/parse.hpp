@@ -0,0 +1,188 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <geofun/primitives.hpp>
+
+namespace geofun {
+
+inline bool is_digit(const char c) {
+  return c >= '0' && c <= '9';
+}
+
+
+inline bool is_space(const char c) {
+  return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+
+inline std::string_view trim(std::string_view text) {
+  while (!text.empty() && is_space(text.front())) {
+    text.remove_prefix(1);
+  }
+  while (!text.empty() && is_space(text.back())) {
+    text.remove_suffix(1);
+  }
+  return text;
+}
+
+
+/**
+ * Scan decimal number, without exponent, at the start of text into value.
+ * Returns the number of characters used, or 0 when text doesn't start with a
+ * number. The result is correctly rounded: mantissas up to 2^53 with at most
+ * 22 decimals take a single division or multiplication by an exact power of
+ * ten, anything longer goes through strtod.
+ */
+inline size_t scan_float(const std::string_view text, double& value) {
+  static constexpr double powers_of_ten[] = {
+    1E0, 1E1, 1E2, 1E3, 1E4, 1E5, 1E6, 1E7, 1E8, 1E9, 1E10, 1E11,
+    1E12, 1E13, 1E14, 1E15, 1E16, 1E17, 1E18, 1E19, 1E20, 1E21, 1E22
+  };
+  static constexpr uint64_t max_mantissa = 100000000000000000ull;
+  static constexpr uint64_t max_exact_mantissa = uint64_t(1) << 53;
+  size_t i = 0;
+  const bool negative = i < text.size() && text[i] == '-';
+  if (i < text.size() && (text[i] == '-' || text[i] == '+')) {
+    ++i;
+  }
+  uint64_t mantissa = 0;
+  int exponent = 0;
+  bool found = false;
+  for (; i < text.size() && is_digit(text[i]); ++i) {
+    found = true;
+    if (mantissa < max_mantissa) {
+      mantissa = 10 * mantissa + (text[i] - '0');
+    }
+    else {
+      ++exponent;
+    }
+  }
+  if (i < text.size() && text[i] == '.') {
+    size_t j = i + 1;
+    for (; j < text.size() && is_digit(text[j]); ++j) {
+      found = true;
+      if (mantissa < max_mantissa) {
+        mantissa = 10 * mantissa + (text[j] - '0');
+        --exponent;
+      }
+    }
+    if (found) {
+      i = j;
+    }
+  }
+  if (!found) {
+    return 0;
+  }
+  if (mantissa > max_exact_mantissa || exponent < -22 || exponent > 22) {
+    // Text isn't null terminated, so strtod needs a copy
+    value = std::strtod(std::string(text.substr(0, i)).c_str(), nullptr);
+    return i;
+  }
+  double result = static_cast<double>(mantissa);
+  if (exponent < 0) {
+    result /= powers_of_ten[-exponent];
+  }
+  else if (exponent > 0) {
+    result *= powers_of_ten[exponent];
+  }
+  value = negative ? -result : result;
+  return i;
+}
+
+
+/**
+ * Scan the numbers in text into values, skipping any other characters. Returns
+ * the number of numbers found, of which only the first capacity are stored.
+ * Clears integral when text contains anything but digits, whitespace and minus
+ * signs.
+ */
+inline size_t scan_floats(const std::string_view text, double* values, const size_t capacity, bool& integral) {
+  size_t count = 0;
+  size_t i = 0;
+  while (i < text.size()) {
+    double value;
+    const size_t length = scan_float(text.substr(i), value);
+    if (length > 0) {
+      if (count < capacity) {
+        values[count] = value;
+      }
+      ++count;
+    }
+    for (const size_t end = i + std::max(length, size_t(1)); i < end; ++i) {
+      integral &= is_space(text[i]) || is_digit(text[i]) || text[i] == '-';
+    }
+  }
+  return count;
+}
+
+
+/**
+ * Parse NMEA 0183 angle field "dddmm.mmmm" with hemisphere field
+ */
+bool parse_nmea_angle(const std::string_view field, const std::string_view hemisphere,
+    const char positive, const char negative, const double limit, double& angle);
+
+
+/**
+ * Parse position from NMEA 0183 fields "ddmm.mmmm,N,dddmm.mmmm,E"
+ */
+bool parse_nmea(const std::string_view text, Position& position);
+
+
+enum class PositionFormat {
+  dms,
+  nmea
+};
+
+
+PositionFormat get_position_format(const std::string& name);
+
+
+/**
+ * Get days since 1970-01-01 of a date in the proleptic Gregorian calendar
+ */
+int64_t days_from_civil(int64_t year, const unsigned month, const unsigned day);
+
+
+inline bool parse_digits(const std::string_view text, const size_t position, const size_t count, int& value) {
+  if (position + count > text.size()) {
+    return false;
+  }
+  value = 0;
+  for (size_t i = position; i < position + count; ++i) {
+    if (!is_digit(text[i])) {
+      return false;
+    }
+    value = 10 * value + (text[i] - '0');
+  }
+  return true;
+}
+
+
+/**
+ * Parse time as seconds since the epoch, either as a number or in ISO 8601
+ * format "YYYY-MM-DD[Thh:mm[:ss.sss]][Z|+hh:mm]". Times without offset are UTC.
+ */
+bool parse_time(std::string_view text, double& seconds);
+
+
+/**
+ * Split line at delimiter into fields, reusing the storage of fields
+ */
+void split_fields(const std::string_view line, const char delimiter, std::vector<std::string_view>& fields);
+
+
+/**
+ * Check the checksum of an NMEA 0183 sentence when it has one
+ */
+bool nmea_checksum_valid(const std::string_view sentence);
+
+}  // namespace geofun
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <geofun/angles.hpp>
+#include <geofun/ellipsoid.hpp>
+#include <geofun/lines.hpp>
+
+namespace geofun {
+
+/**
+ * Polygon of positions with area, perimeter and point in polygon tests, with
+ * orthodrome or loxodrome edges. Loxodrome edges are straight lines in
+ * longitude and isometric latitude, crossed by a ray east along the parallel
+ * of the position. Geodesic edges are crossed by a ray north along the
+ * meridian of the position. The edges are prepared once and indexed by bands
+ * of isometric latitude and of longitude, so a test only visits the edges
+ * crossing the band of the position.
+ */
+class Polygon {
+public:
+  /**
+   * Construct polygon on vertex coordinates: anything with size(),
+   * latitude(i) and longitude(i)
+   */
+  template <typename Coordinates>
+  Polygon(const Coordinates& coordinates, const Ellipsoid& ellipsoid):
+      ellipsoid_(ellipsoid), eccentricity_(ellipsoid.get_eccentricity()) {
+    const std::ptrdiff_t size = coordinates.size();
+    latitudes_.resize(size);
+    longitudes_.resize(size);
+    for (std::ptrdiff_t i = 0; i < size; ++i) {
+      latitudes_[i] = coordinates.latitude(i);
+      longitudes_[i] = coordinates.longitude(i);
+    }
+    prepare();
+  }
+
+  std::ptrdiff_t size() const {
+    return static_cast<std::ptrdiff_t>(latitudes_.size());
+  }
+
+  const double* latitudes() const {
+    return latitudes_.data();
+  }
+
+  const double* longitudes() const {
+    return longitudes_.data();
+  }
+
+  /**
+   * Get area in square meters with orthodrome or loxodrome edges. The area
+   * doesn't depend on the orientation of the vertices.
+   */
+  double get_area(const std::string& kind) const {
+    return measure(get_line_kind(kind)).second;
+  }
+
+  double get_perimeter(const std::string& kind) const {
+    return measure(get_line_kind(kind)).first;
+  }
+
+  bool contains(const double latitude, const double longitude, const LineKind kind) const {
+    return kind == LineKind::loxo ? contains_loxo(latitude, longitude) : contains_ortho(latitude, longitude);
+  }
+
+private:
+  struct Edge {
+    double x1;
+    double y1;
+    double x2;
+    double y2;
+  };
+
+  /**
+   * Geodesic of an edge from its west end, and the latitude range it spans.
+   * Edges along a pole have a NaN azimuth.
+   */
+  struct GeodesicEdge {
+    double latitude;
+    double longitude;
+    double azimuth;
+    double min_latitude;
+    double max_latitude;
+  };
+
+  /**
+   * Index of the edges by bands of a coordinate: the edges with a range of
+   * the coordinate overlapping band i are edges[offsets[i]:offsets[i + 1]]
+   */
+  struct Bands {
+    double min;
+    double scale;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> edges;
+
+    size_t get(const double value) const {
+      const size_t band = static_cast<size_t>((value - min) * scale);
+      return std::min(band, offsets.size() - 2);
+    }
+  };
+
+  bool contains_loxo(const double latitude, const double longitude) const {
+    const double y = isometric_latitude(latitude, eccentricity_);
+    if (!(y >= min_y_ && y <= max_y_) || !std::isfinite(longitude)) {
+      return false;
+    }
+    const size_t band = latitude_bands_.get(y);
+    // Edge longitudes are unwrapped, so try each turn of longitude in their range
+    for (double x = min_x_ + angle_mod(longitude - min_x_); x <= max_x_; x += 360.0) {
+      bool inside = false;
+      for (uint32_t i = latitude_bands_.offsets[band]; i < latitude_bands_.offsets[band + 1]; ++i) {
+        const Edge& edge = edges_[latitude_bands_.edges[i]];
+        if ((edge.y1 > y) != (edge.y2 > y)
+            && x < edge.x1 + (y - edge.y1) * (edge.x2 - edge.x1) / (edge.y2 - edge.y1)) {
+          inside = !inside;
+        }
+      }
+      if (inside) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * Count the geodesic edges north of the position. Only edges whose
+   * latitude range contains the position need a geodesic: the position is
+   * south of the edge when the geodesic to it from the west end of the edge
+   * heads further south than the edge does. That holds for edges shorter
+   * than half the globe.
+   */
+  bool contains_ortho(const double latitude, const double longitude) const;
+
+  template <typename Area>
+  std::pair<double, double> measure(Area area) const;
+
+  /**
+   * Get perimeter and area with orthodrome or loxodrome edges
+   */
+  std::pair<double, double> measure(const LineKind kind) const;
+
+  /**
+   * Index edges by bands between min and max of the coordinate, given the
+   * range of the coordinate of each edge
+   */
+  static Bands make_bands(const std::vector<std::pair<double, double>>& ranges, const double min, const double max);
+
+  /**
+   * Check the vertices and build the edges in longitude and isometric
+   * latitude, their geodesics and the band indices
+   */
+  void prepare();
+
+  Ellipsoid ellipsoid_;
+  double eccentricity_;
+  std::vector<double> latitudes_;
+  std::vector<double> longitudes_;
+  std::vector<Edge> edges_;
+  std::vector<GeodesicEdge> geodesic_edges_;
+  double min_x_;
+  double max_x_;
+  double min_y_;
+  double max_y_;
+  Bands latitude_bands_;
+  Bands longitude_bands_;
+};
+
+}  // namespace geofun
@@ -0,0 +1,607 @@
+#pragma once
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include <geofun/angles.hpp>
+#include <geofun/ellipsoid.hpp>
+#include <geofun/stats.hpp>
+
+namespace geofun {
+
+struct Vector;
+struct Position;
+struct VectorArray;
+struct PositionArray;
+
+struct Point {
+  Point() = default;
+  Point(const Point&) = default;
+  Point(Point&&) = default;
+  Point(const double x, const double y): x_(x), y_(y) {}
+  Point(const std::vector<double>& initializer) {
+    if (initializer.size() != 2) {
+      throw std::out_of_range("Initializer length isn't 2 in construction of point");
+    }
+    set_x(initializer[0]);
+    set_y(initializer[1]);
+  }
+  Point& operator=(const Point&) = default;
+  Point& operator=(Point&&) = default;
+
+  double get_x() const {
+    return x_;
+  }
+
+  double get_y() const {
+    return y_;
+  }
+
+  Point& set_x(const double x) {
+    x_ = x;
+    return *this;
+  }
+
+  Point& set_y(const double y) {
+    y_ = y;
+    return *this;
+  }
+
+  bool operator==(const Point& point) const {
+    return floats_equal(x_, point.x_) && floats_equal(y_, point.y_);
+  }
+
+  bool operator==(const std::vector<double>& other) const {
+    if (other.size() != 2) {
+      throw std::out_of_range(fmt::format("Can't compare Point to container of size {}", other.size()));
+    }
+    return floats_equal(get_x(), other[0]) && floats_equal(get_y(), other[1]);
+  }
+
+  Point& operator+=(const Point& point) {
+    x_ += point.x_;
+    y_ += point.y_;
+    return *this;
+  }
+
+  Point& operator-=(const Point& point) {
+    x_ -= point.x_;
+    y_ -= point.y_;
+    return *this;
+  }
+
+  Point& operator+=(const Vector& vector);
+  Point& operator-=(const Vector& vector);
+
+  Point operator+(const Point& point) const {
+    Point result(*this);
+    result += point;
+    return result;
+  }
+
+
+  Point operator-(const Point& point) const {
+    Point result(*this);
+    result -= point;
+    return result;
+  }
+
+  Point& operator*=(const double multiplier) {
+    x_ *= multiplier;
+    y_ *= multiplier;
+    return *this;
+  }
+
+  Point operator*(const double multiplier) const {
+    Point result(*this);
+    result *= multiplier;
+    return result;
+  }
+
+  Point operator-() const {
+    return Point(-x_, -y_);
+  }
+
+  double get_item(int i) const {
+    i = i < 0 ? i + 2 : i;
+    switch(i) {
+      case 0: return get_x();
+      case 1: return get_y();
+      default: throw std::out_of_range(fmt::format("Index {} is out of range for Point", i));
+    }
+  }
+
+  Point& set_item(int i, const double value) {
+    i = i < 0 ? i + 2 : i;
+    switch(i) {
+      case 0: return set_x(value);
+      case 1: return set_y(value);
+      default: throw std::out_of_range(fmt::format("Index {} is out of range for Point", i));
+    }
+  }
+
+  constexpr int get_len() const {
+    return 2;
+  }
+
+  double operator[](const int i) {
+    return get_item(i);
+  }
+
+  double* data() {
+    return &x_;
+  }
+
+  std::string get_string() const {
+    return fmt::format("{:.3f}, {:.3f}", x_, y_);
+  }
+
+  std::string get_representation() const {
+    double i;
+    double x_frac = modf(x_, &i);
+    double y_frac = modf(y_, &i);
+    std::string format = x_frac == 0.0 ? "Point({:.1f}" : "Point({:.15g}";
+    format += y_frac == 0.0 ? ", {:.1f})" : ", {:.15g})";
+    return fmt::format(fmt::runtime(format), x_, y_);
+  }
+
+private:
+  friend struct Vector;
+  double x_;
+  double y_;
+};
+
+
+struct Vector {
+  Vector() = default;
+  Vector(const Vector&) = default;
+  Vector(Vector&&) = default;
+  Vector(const double azimuth, const double length): azimuth_(), length_() {
+    set_azimuth(azimuth);
+    set_length(length);
+  }
+  Vector(const Point& point): azimuth_(), length_() {
+    set_x_y(point.x_, point.y_);
+  }
+  Vector(const std::vector<double>& initializer) {
+    if (initializer.size() != 2) {
+      throw std::out_of_range("Initializer length isn't 2 in construction of vector");
+    }
+    set_azimuth(initializer[0]);
+    set_length(initializer[1]);
+  }
+  Vector& operator=(const Vector&) = default;
+  Vector& operator=(Vector&&) = default;
+
+  double get_azimuth() const {
+    return azimuth_;
+  }
+
+  double get_length() const {
+    return length_;
+  }
+
+  Vector& set_azimuth(const double azimuth) {
+    azimuth_ = angle_mod(azimuth);
+    return *this;
+  }
+
+  Vector& set_length(const double length) {
+    // Prefer a positive length
+    if (length < 0) {
+      set_azimuth(azimuth_ + 180.0);
+      length_ = -length;
+    }
+    else {
+      length_ = length;
+    }
+    return *this;
+  }
+
+  double get_x() const {
+    return cos(d2r * azimuth_) * length_;
+  }
+
+  double get_y() const {
+    return sin(d2r * azimuth_) * length_;
+  }
+
+  Vector& set_x(const double x) {
+    set_x_y(x, get_y());
+    return *this;
+  }
+
+  Vector& set_y(const double y) {
+    set_x_y(get_x(), y);
+    return *this;
+  }
+
+  Vector& set_x_y(const double x, const double y) {
+    azimuth_ = r2d * atan2(y, x);
+    azimuth_ = azimuth_ < 0 ? azimuth_ + 360.0 : azimuth_;
+    length_ = hypot(x, y);
+    return *this;
+  }
+
+  bool operator==(const Vector& vector) const {
+    return floats_equal(azimuth_, vector.azimuth_) && floats_equal(length_, vector.length_);
+  }
+
+  bool operator==(const Point& point) const {
+    return floats_equal(get_x(), point.get_x()) && floats_equal(get_y(), point.get_y());
+  }
+
+  bool operator==(const std::vector<double>& other) const {
+    if (other.size() != 2) {
+      throw std::out_of_range(fmt::format("Can't compare Vector to container of size {}", other.size()));
+    }
+    return floats_equal(get_azimuth(), other[0]) && floats_equal(get_length(), other[1]);
+  }
+
+  Vector& operator+=(const Vector& vector) {
+    set_x_y(get_x() + vector.get_x(), get_y() + vector.get_y());
+    return *this;
+  }
+
+  Vector& operator-=(const Vector& vector) {
+    set_x_y(get_x() - vector.get_x(), get_y() - vector.get_y());
+    return *this;
+  }
+
+  Vector& operator+=(const double angle) {
+    return set_azimuth(azimuth_ + angle);
+  }
+
+  Vector& operator-=(const double angle) {
+    return set_azimuth(azimuth_ - angle);
+  }
+
+  Vector& operator*=(const double multiplier) {
+    return set_length(length_ * multiplier);
+  }
+
+  Vector& operator/=(const double divider) {
+    return set_length(length_ / divider);
+  }
+
+  Vector operator+(const Vector& vector) const {
+    Vector result(*this);
+    result += vector;
+    return result;
+  }
+
+  Vector operator-(const Vector& vector) const {
+    Vector result(*this);
+    result -= vector;
+    return result;
+  }
+
+  Vector operator+(const double angle) const {
+    Vector result(*this);
+    result += angle;
+    return result;
+  }
+
+  Vector operator-(const double angle) const {
+    Vector result(*this);
+    result -= angle;
+    return result;
+  }
+
+  Vector operator*(const double multiplier) const {
+    Vector result(*this);
+    result *= multiplier;
+    return result;
+  }
+
+  Vector operator/(const double divider) const {
+    Vector result(*this);
+    result /= divider;
+    return result;
+  }
+
+  Vector operator-() const {
+    return Vector(azimuth_ + 180.0, length_);
+  }
+
+  Vector norm() const {
+    return Vector(azimuth_, 1.0);
+  }
+
+  double dot(const Vector& vector) const {
+    return length_ * vector.length_ * cos(d2r * (vector.azimuth_ - azimuth_));
+  }
+
+  double cross(const Vector& vector) const {
+    return length_ * vector.length_ * sin(d2r * (vector.azimuth_ - azimuth_));
+  }
+
+  Point point() const {
+    return Point(get_x(), get_y());
+  }
+
+  double get_item(int i) const {
+    i = i < 0 ? i + 2 : i;
+    switch(i) {
+      case 0: return get_azimuth();
+      case 1: return get_length();
+      default: throw std::out_of_range(fmt::format("Index {} is out of range for Vector", i));
+    }
+  }
+
+  Vector& set_item(int i, const double value) {
+    i = i < 0 ? i + 2 : i;
+    switch(i) {
+      case 0: return set_azimuth(value);
+      case 1: return set_length(value);
+      default: throw std::out_of_range(fmt::format("Index {} is out of range for Vector", i));
+    }
+  }
+
+  constexpr int get_len() const {
+    return 2;
+  }
+
+  double operator[](const int i) {
+    return get_item(i);
+  }
+
+  const double* data() const {
+    return &azimuth_;
+  }
+
+  std::string get_string() const {
+    return fmt::format("{:.3f}, {:.3f}", azimuth_, length_);
+  }
+
+  std::string get_representation() const {
+    double i;
+    double x_frac = modf(azimuth_, &i);
+    double y_frac = modf(length_, &i);
+    std::string format = x_frac == 0.0 ? "Vector({:.1f}" : "Vector({:.15g}";
+    format += y_frac == 0.0 ? ", {:.1f})" : ", {:.15g})";
+    return fmt::format(fmt::runtime(format), azimuth_, length_);
+  }
+
+  std::vector<Position> split_ortho(const Position& start, const int number_of_segments, const Ellipsoid* ellipsoid) const;
+  std::vector<Position> split_loxo(const Position& start, const int number_of_segments, const Ellipsoid* ellipsoid) const;
+private:
+  friend struct Position;
+  friend struct VectorArray;
+  double azimuth_;
+  double length_;
+};
+
+
+/**
+ * Parse position from latitude and longitude strings of degrees, optionally
+ * followed by minutes and seconds, with hemisphere letters. When longitude is
+ * empty, both are taken from latitude. Strings of only integers are in arc
+ * seconds. Sets count to the number of values found and returns whether the
+ * position was set.
+ */
+bool parse_dms(const std::string_view latitude, const std::string_view longitude, Position& position, int& count);
+
+
+struct Position {
+  Position() = default;
+  Position(const Position&) = default;
+  Position(Position&&) = default;
+
+  Position(const double latitude, const double longitude): latitude_(), longitude_() {
+    set_latitude(latitude);
+    set_longitude(longitude);
+  }
+
+  Position(const int latitude, const int longitude): latitude_(), longitude_() {
+    set_latitude_seconds(latitude);
+    set_longitude_seconds(longitude);
+  }
+
+  Position(const std::vector<double>& initializer) {
+    if (initializer.size() != 2) {
+      throw std::out_of_range("Initializer length isn't 2 in construction of Position");
+    }
+    set_latitude(initializer[0]);
+    set_longitude(initializer[1]);
+  }
+
+  Position(const std::string& latitude, const std::string& longitude): latitude_(), longitude_() {
+    int count;
+    if (!parse_dms(latitude, longitude, *this, count)) {
+      throw std::invalid_argument(fmt::format("Invalid argument count: {} for Position", count));
+    }
+  }
+
+  Position& operator=(const Position&) = default;
+  Position& operator=(Position&&) = default;
+
+  double get_latitude() const {
+    return latitude_;
+  }
+
+  double get_longitude() const {
+    return longitude_;
+  }
+
+  Position& set_latitude(const double latitude) {
+    latitude_ = angle_mod_signed(latitude);
+    latitude_ = latitude_ > 90.0 ? 180.0 - latitude_ : latitude_ < -90.0 ? -180.0 - latitude_ : latitude_;
+    return *this;
+  }
+
+  Position& set_latitude_seconds(const int latitude) {
+    return set_latitude(latitude / 3600.0);
+  }
+
+  Position& set_longitude(const double longitude) {
+    longitude_ = angle_mod_signed(longitude);
+    return *this;
+  }
+
+  Position& set_longitude_seconds(const int longitude) {
+    return set_longitude(longitude / 3600.0);
+  }
+
+  bool operator==(const Position& position) const {
+    return floats_equal(latitude_, position.latitude_) && floats_equal(longitude_, position.longitude_);
+  }
+
+  bool operator==(const std::vector<double>& other) const {
+    if (other.size() != 2) {
+      throw std::out_of_range(fmt::format("Can't compare Position to container of size {}", other.size()));
+    }
+    return floats_equal(get_latitude(), other[0]) && floats_equal(get_longitude(), other[1]);
+  }
+
+  Position& operator+=(const Vector& vector) {
+    GEOFUN_PROBE(position_add);
+    const gl::Rhumb& rhumb = get_wgs84().rhumb();
+    double latitude;
+    double longitude;
+    rhumb.Direct(latitude_, longitude_, vector.azimuth_, vector.length_, latitude, longitude);
+    latitude_ = latitude;
+    longitude_ = longitude;
+    return *this;
+  }
+
+  Position& operator-=(const Vector& vector) {
+    GEOFUN_PROBE(position_subtract);
+    const gl::Rhumb& rhumb = get_wgs84().rhumb();
+    double latitude;
+    double longitude;
+    rhumb.Direct(latitude_, longitude_, vector.azimuth_, -vector.length_, latitude, longitude);
+    latitude_ = latitude;
+    longitude_ = longitude;
+    return *this;
+  }
+
+  Position& operator*=(const Vector& vector) {
+    GEOFUN_PROBE(position_multiply);
+    const gl::Geodesic& geodesic = get_wgs84().geodesic();
+    double latitude;
+    double longitude;
+    // Without the final azimuth, which isn't kept
+    geodesic.Direct(latitude_, longitude_, vector.azimuth_, vector.length_, latitude, longitude);
+    latitude_ = latitude;
+    longitude_ = longitude;
+    return *this;
+  }
+
+  Position& operator/=(const Vector& vector) {
+    GEOFUN_PROBE(position_divide);
+    const gl::Geodesic& geodesic = get_wgs84().geodesic();
+    double latitude;
+    double longitude;
+    geodesic.Direct(latitude_, longitude_, vector.azimuth_, -vector.length_, latitude, longitude);
+    latitude_ = latitude;
+    longitude_ = longitude;
+    return *this;
+  }
+
+  Position operator+(const Vector& vector) const {
+    Position result(*this);
+    result += vector;
+    return result;
+  }
+
+  Position operator-(const Vector& vector) const {
+    Position result(*this);
+    result -= vector;
+    return result;
+  }
+
+  Position operator*(const Vector& vector) const {
+    Position result(*this);
+    result *= vector;
+    return result;
+  }
+
+  Position operator/(const Vector& vector) const {
+    Position result(*this);
+    result /= vector;
+    return result;
+  }
+
+  double get_item(int i) const {
+    i = i < 0 ? i + 2 : i;
+    switch(i) {
+      case 0: return get_latitude();
+      case 1: return get_longitude();
+      default: throw std::out_of_range(fmt::format("Index {} is out of range for Position", i));
+    }
+  }
+
+  Position& set_item(int i, const double value) {
+    i = i < 0 ? i + 2 : i;
+    switch(i) {
+      case 0: return set_latitude(value);
+      case 1: return set_longitude(value);
+      default: throw std::out_of_range(fmt::format("Index {} is out of range for Position", i));
+    }
+  }
+
+  constexpr int get_len() const {
+    return 2;
+  }
+
+  double operator[](const int i) {
+    return get_item(i);
+  }
+
+  const double* data() const {
+    return &latitude_;
+  }
+
+  std::string get_string() const {
+    return fmt::format("{:.8f}, {:.8f}", latitude_, longitude_);
+  }
+
+  std::string get_representation() const {
+    double i;
+    double x_frac = modf(latitude_, &i);
+    double y_frac = modf(longitude_, &i);
+    std::string format = x_frac == 0.0 ? "Position({:.1f}" : "Position({:.15g}";
+    format += y_frac == 0.0 ? ", {:.1f})" : ", {:.15g})";
+    return fmt::format(fmt::runtime(format), latitude_, longitude_);
+  }
+
+private:
+  friend struct PositionArray;
+  double latitude_;
+  double longitude_;
+};
+
+
+// The buffer protocol exposes the coordinate pairs directly
+static_assert(sizeof(Point) == 2 * sizeof(double), "Point should consist of two packed doubles");
+static_assert(sizeof(Vector) == 2 * sizeof(double), "Vector should consist of two packed doubles");
+static_assert(sizeof(Position) == 2 * sizeof(double), "Position should consist of two packed doubles");
+
+
+Point operator*(const double multiplier, const Point& point);
+bool operator==(const Point& point, const Vector& vector);
+Vector operator*(const double multiplier, const Vector& vector);
+Vector operator+(const double angle, const Vector& vector);
+Vector operator-(const double angle, const Vector& vector);
+Point operator+(const Point& point, const Vector& vector);
+Point operator-(const Point& point, const Vector& vector);
+
+
+/**
+ * Get vector of the rhumb line from position1 to position2
+ */
+Vector operator-(const Position& position2, const Position& position1);
+
+
+/**
+ * Get vector of the geodesic from position1 to position2
+ */
+Vector operator/(const Position& position2, const Position& position1);
+
+}  // namespace geofun
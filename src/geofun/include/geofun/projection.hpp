@@ -0,0 +1,74 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <GeographicLib/AzimuthalEquidistant.hpp>
+#include <GeographicLib/LocalCartesian.hpp>
+#include <GeographicLib/TransverseMercator.hpp>
+
+#include <geofun/ellipsoid.hpp>
+#include <geofun/primitives.hpp>
+
+namespace geofun {
+
+enum class ProjectionKind {
+  local,
+  transverse_mercator,
+  azimuthal_equidistant
+};
+
+
+ProjectionKind get_projection_kind(const std::string& name);
+
+
+/**
+ * Projection of positions to points in a flat coordinate system around an
+ * origin, x pointing north and y pointing east like Point. The "local" kind
+ * is the tangent plane at the origin, onto which positions are projected
+ * along the vertical of the origin, so only flat near it. Transverse
+ * Mercator is conformal and azimuthal equidistant keeps distances and
+ * azimuths from the origin exact, which both suit larger areas.
+ */
+class Projector {
+public:
+  Projector(const Position& origin, const std::string& kind, const Ellipsoid& ellipsoid);
+
+  const Position& get_origin() const {
+    return origin_;
+  }
+
+  void forward(const double latitude, const double longitude, double& x, double& y) const;
+
+  void reverse(const double x, const double y, double& latitude, double& longitude) const;
+
+  Point forward(const Position& position) const {
+    double x;
+    double y;
+    forward(position.get_latitude(), position.get_longitude(), x, y);
+    return Point(x, y);
+  }
+
+  Position reverse(const Point& point) const {
+    double latitude;
+    double longitude;
+    reverse(point.get_x(), point.get_y(), latitude, longitude);
+    return Position(latitude, longitude);
+  }
+
+private:
+  double get_local_height(const double x, const double y) const;
+
+  Position origin_;
+  ProjectionKind kind_;
+  gl::LocalCartesian local_;
+  gl::TransverseMercator transverse_mercator_;
+  gl::AzimuthalEquidistant azimuthal_equidistant_;
+  // Transverse Mercator northing of the origin
+  double northing_;
+  // Geocentric origin and rotation from its local to geocentric coordinates
+  double center_[3];
+  std::vector<double> rotation_;
+};
+
+}  // namespace geofun
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace geofun {
+
+/**
+ * Instrumented operations. Probes only count when the library is built with
+ * GEOFUN_STATS defined, otherwise they compile to nothing.
+ */
+enum class Probe {
+  rhumb_direct,
+  rhumb_inverse,
+  geodesic_direct,
+  geodesic_inverse,
+  position_add,
+  position_subtract,
+  position_multiply,
+  position_divide,
+  position_loxo,
+  position_ortho,
+  position_array_add,
+  position_array_subtract,
+  position_array_multiply,
+  position_array_divide,
+  position_array_loxo,
+  position_array_ortho,
+  rhumb_direct_batch,
+  rhumb_inverse_batch,
+  geodesic_direct_batch,
+  geodesic_inverse_batch,
+  rhumb_distance_batch,
+  rhumb_azimuth_batch,
+  geodesic_distance_batch,
+  geodesic_azimuth_batch,
+  distance_matrix,
+  track_metrics,
+  count
+};
+
+
+#ifdef GEOFUN_STATS
+constexpr bool stats_enabled = true;
+#else
+constexpr bool stats_enabled = false;
+#endif
+
+
+/**
+ * Totals of a probe over all threads: number of calls, number of elements
+ * processed by those calls and cumulative time in seconds
+ */
+struct ProbeStats {
+  const char* name;
+  uint64_t calls;
+  uint64_t items;
+  double time;
+};
+
+
+/**
+ * Get the totals of the probes that were called since the last reset. Empty
+ * when the library is built without GEOFUN_STATS.
+ */
+std::vector<ProbeStats> get_stats();
+
+
+void reset_stats();
+
+
+/**
+ * Add a call of probe processing items elements in nanoseconds to the slot
+ * of the calling thread
+ */
+void record_probe(const Probe probe, const uint64_t items, const uint64_t nanoseconds);
+
+
+/**
+ * Records the time between construction and destruction as a call of probe
+ */
+class ScopedProbe {
+public:
+  explicit ScopedProbe(const Probe probe, const std::ptrdiff_t items = 1):
+      probe_(probe), items_(items), start_(std::chrono::steady_clock::now()) {}
+  ScopedProbe(const ScopedProbe&) = delete;
+  ScopedProbe& operator=(const ScopedProbe&) = delete;
+
+  ~ScopedProbe() {
+    const auto elapsed = std::chrono::steady_clock::now() - start_;
+    record_probe(probe_, static_cast<uint64_t>(items_),
+        static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+  }
+
+private:
+  Probe probe_;
+  std::ptrdiff_t items_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace geofun
+
+
+/**
+ * Time the rest of the enclosing scope as a call of probe, with optionally
+ * the number of elements it processes
+ */
+#ifdef GEOFUN_STATS
+#define GEOFUN_PROBE(...) const ::geofun::ScopedProbe geofun_probe_(::geofun::Probe::__VA_ARGS__)
+#else
+#define GEOFUN_PROBE(...) static_cast<void>(0)
+#endif
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <geofun/distance.hpp>
+#include <geofun/ellipsoid.hpp>
+
+namespace geofun {
+
+enum class TrackFormat {
+  csv,
+  nmea
+};
+
+
+/**
+ * Reader of track files that parses chunks of records into arrays of times,
+ * latitudes and longitudes. The file is read through a fixed size buffer,
+ * so memory use doesn't depend on the size of the file. Optionally the
+ * distances and azimuths of the legs between consecutive records are
+ * computed, carrying the last position over to the next chunk.
+ */
+class TrackReader {
+public:
+  TrackReader(const std::string& path, const std::string& format, const std::ptrdiff_t chunk_size,
+      const std::optional<std::string>& time_column, const std::string& latitude_column, const std::string& longitude_column,
+      const char delimiter, const bool legs, const std::string& metric, const Ellipsoid* ellipsoid);
+
+  /**
+   * Read the next chunk of at most chunk_size records, computing the legs
+   * when requested. Returns the number of records, which is zero at the end
+   * of the file. The records stay valid until the next call.
+   */
+  std::ptrdiff_t read() {
+    const std::ptrdiff_t count = fill();
+    if (legs_ && count > 0) {
+      compute_legs(count);
+    }
+    return count;
+  }
+
+  const double* times() const {
+    return times_.data();
+  }
+
+  const double* latitudes() const {
+    return latitudes_.data();
+  }
+
+  const double* longitudes() const {
+    return longitudes_.data();
+  }
+
+  bool has_legs() const {
+    return legs_;
+  }
+
+  /**
+   * Distances of the legs from the previous records, NaN for the first
+   * record of the file
+   */
+  const double* distances() const {
+    return distances_.data();
+  }
+
+  const double* azimuths() const {
+    return azimuths_.data();
+  }
+
+  /**
+   * Number of records that couldn't be parsed so far
+   */
+  std::ptrdiff_t get_skipped() const {
+    return skipped_;
+  }
+
+private:
+  enum class Record {
+    valid,
+    ignored,
+    invalid
+  };
+
+  static constexpr size_t no_column = std::numeric_limits<size_t>::max();
+
+  /**
+   * Get the next line from the buffer, reading from the file when needed.
+   * The line is valid until the next call.
+   */
+  bool next_line(std::string_view& line);
+
+  std::ptrdiff_t fill();
+
+  Record parse_csv(const std::string_view line, double& time, double& latitude, double& longitude);
+
+  /**
+   * Parse RMC and GGA sentences. GGA sentences don't have a date, so they
+   * take the date of the last RMC sentence, rolled over at midnight, and are
+   * ignored before the first RMC sentence. Sentences for the same time as
+   * the last record are ignored, as receivers often send both for a fix.
+   */
+  Record parse_nmea(const std::string_view line, double& time, double& latitude, double& longitude);
+
+  void compute_legs(const std::ptrdiff_t count);
+
+  std::unique_ptr<std::FILE, int (*)(std::FILE*)> file_;
+  std::vector<char> buffer_;
+  size_t begin_ = 0;
+  size_t end_ = 0;
+  bool eof_ = false;
+  TrackFormat format_;
+  std::ptrdiff_t chunk_size_;
+  char delimiter_;
+  bool legs_;
+  Metric metric_;
+  Ellipsoid ellipsoid_;
+  size_t time_index_ = no_column;
+  size_t latitude_index_ = 0;
+  size_t longitude_index_ = 0;
+  std::vector<std::string_view> fields_;
+  std::vector<double> times_;
+  std::vector<double> latitudes_;
+  std::vector<double> longitudes_;
+  std::vector<double> distances_;
+  std::vector<double> azimuths_;
+  double day_ = std::numeric_limits<double>::quiet_NaN();
+  double last_time_of_day_ = std::numeric_limits<double>::quiet_NaN();
+  double last_time_ = std::numeric_limits<double>::quiet_NaN();
+  double last_latitude_ = std::numeric_limits<double>::quiet_NaN();
+  double last_longitude_ = std::numeric_limits<double>::quiet_NaN();
+  std::ptrdiff_t skipped_ = 0;
+};
+
+
+/**
+ * Outputs of compute_track_metrics, arrays with a value per record
+ */
+struct TrackMetrics {
+  double* distances;
+  double* azimuths;
+  double* final_azimuths;
+  double* speeds;
+  double* courses;
+  double* cumulative_distances;
+  double* turn_rates;
+};
+
+
+/**
+ * Legs shorter than this many meters are between repeated fixes of a vessel
+ * that didn't move, which keeps its course
+ */
+constexpr double stationary_distance = 1e-3;
+
+
+/**
+ * Get metrics of the tracks in size records: per record the leg from the
+ * previous record, speed, course over ground, cumulative distance and turn
+ * rate. Records of a track are consecutive and in order of time. When ids
+ * isn't null, each change of id starts a new track.
+ */
+void compute_track_metrics(const double* time, const double* latitude, const double* longitude,
+    const std::ptrdiff_t size, const int64_t* id, const Metric metric, const int threads, const Ellipsoid& ellipsoid,
+    const TrackMetrics& metrics);
+
+}  // namespace geofun
@@ -0,0 +1,320 @@
+#include <geofun/angles.hpp>
+
+#include <geofun/parallel.hpp>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define GEOFUN_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+namespace geofun {
+
+/**
+ * Ranges that angles are reduced to
+ */
+enum class AngleRange {
+  // [0, 360>, like angle_mod
+  full,
+  // [-180, 180>, like angle_mod_signed
+  half,
+  // [-90, 90], like Position::set_latitude
+  latitude
+};
+
+
+/**
+ * Reduce a single angle, exactly like the scalar functions do for double.
+ * Float angles are reduced in single precision.
+ */
+template <AngleRange Range, typename T>
+static T reduce_angle(const T angle) {
+  T result = std::fmod(angle, T(360));
+  if constexpr (Range == AngleRange::full) {
+    return result < T(0) ? result + T(360) : result;
+  }
+  result = result < T(-180) ? result + T(360) : result >= T(180) ? result - T(360) : result;
+  if constexpr (Range == AngleRange::latitude) {
+    result = result > T(90) ? T(180) - result : result < T(-90) ? T(-180) - result : result;
+  }
+  return result;
+}
+
+
+template <AngleRange Range, typename T>
+static void reduce_scalar(T* angles, const std::ptrdiff_t size) {
+  for (std::ptrdiff_t i = 0; i < size; ++i) {
+    angles[i] = reduce_angle<Range>(angles[i]);
+  }
+}
+
+
+#ifdef GEOFUN_X86_DISPATCH
+
+// The vector kernels compute fmod(angle, 360) as angle - 360 * trunc(angle / 360)
+// on the magnitude, with a fused multiply-add. Below these limits the product
+// is exact and the rounded quotient is at most one off, which the corrections
+// fix exactly, so the results equal std::fmod. Larger angles, infinities and
+// NaN take the scalar path.
+static constexpr double vector_limit = 70368744177664.0;  // 2^46
+static constexpr float vector_limit_float = 67108864.0f;  // 2^26
+
+
+template <AngleRange Range>
+__attribute__((target("avx2,fma")))
+static void reduce_avx2(double* angles, const std::ptrdiff_t size) {
+  const __m256d full = _mm256_set1_pd(360.0);
+  const __m256d inverse = _mm256_set1_pd(1.0 / 360.0);
+  const __m256d zero = _mm256_setzero_pd();
+  const __m256d sign = _mm256_set1_pd(-0.0);
+  const __m256d limit = _mm256_set1_pd(vector_limit);
+  std::ptrdiff_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    const __m256d angle = _mm256_loadu_pd(angles + i);
+    const __m256d magnitude = _mm256_andnot_pd(sign, angle);
+    if (_mm256_movemask_pd(_mm256_cmp_pd(magnitude, limit, _CMP_LT_OQ)) != 0xF) {
+      reduce_scalar<Range>(angles + i, 4);
+      continue;
+    }
+    const __m256d quotient = _mm256_round_pd(_mm256_mul_pd(magnitude, inverse), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    __m256d result = _mm256_fnmadd_pd(quotient, full, magnitude);
+    result = _mm256_blendv_pd(result, _mm256_add_pd(result, full), _mm256_cmp_pd(result, zero, _CMP_LT_OQ));
+    result = _mm256_blendv_pd(result, _mm256_sub_pd(result, full), _mm256_cmp_pd(result, full, _CMP_GE_OQ));
+    // Like fmod, take the sign of the angle, also for zero
+    result = _mm256_or_pd(result, _mm256_and_pd(angle, sign));
+    if constexpr (Range == AngleRange::full) {
+      result = _mm256_blendv_pd(result, _mm256_add_pd(result, full), _mm256_cmp_pd(result, zero, _CMP_LT_OQ));
+    }
+    else {
+      const __m256d half = _mm256_set1_pd(180.0);
+      const __m256d minus_half = _mm256_set1_pd(-180.0);
+      const __m256d low = _mm256_cmp_pd(result, minus_half, _CMP_LT_OQ);
+      const __m256d high = _mm256_cmp_pd(result, half, _CMP_GE_OQ);
+      result = _mm256_blendv_pd(_mm256_blendv_pd(result, _mm256_sub_pd(result, full), high),
+          _mm256_add_pd(result, full), low);
+      if constexpr (Range == AngleRange::latitude) {
+        const __m256d quarter = _mm256_set1_pd(90.0);
+        const __m256d minus_quarter = _mm256_set1_pd(-90.0);
+        const __m256d north = _mm256_cmp_pd(result, quarter, _CMP_GT_OQ);
+        const __m256d south = _mm256_cmp_pd(result, minus_quarter, _CMP_LT_OQ);
+        result = _mm256_blendv_pd(_mm256_blendv_pd(result, _mm256_sub_pd(minus_half, result), south),
+            _mm256_sub_pd(half, result), north);
+      }
+    }
+    _mm256_storeu_pd(angles + i, result);
+  }
+  reduce_scalar<Range>(angles + i, size - i);
+}
+
+
+template <AngleRange Range>
+__attribute__((target("avx2,fma")))
+static void reduce_avx2(float* angles, const std::ptrdiff_t size) {
+  const __m256 full = _mm256_set1_ps(360.0f);
+  const __m256 inverse = _mm256_set1_ps(1.0f / 360.0f);
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 sign = _mm256_set1_ps(-0.0f);
+  const __m256 limit = _mm256_set1_ps(vector_limit_float);
+  std::ptrdiff_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const __m256 angle = _mm256_loadu_ps(angles + i);
+    const __m256 magnitude = _mm256_andnot_ps(sign, angle);
+    if (_mm256_movemask_ps(_mm256_cmp_ps(magnitude, limit, _CMP_LT_OQ)) != 0xFF) {
+      reduce_scalar<Range>(angles + i, 8);
+      continue;
+    }
+    const __m256 quotient = _mm256_round_ps(_mm256_mul_ps(magnitude, inverse), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    __m256 result = _mm256_fnmadd_ps(quotient, full, magnitude);
+    result = _mm256_blendv_ps(result, _mm256_add_ps(result, full), _mm256_cmp_ps(result, zero, _CMP_LT_OQ));
+    result = _mm256_blendv_ps(result, _mm256_sub_ps(result, full), _mm256_cmp_ps(result, full, _CMP_GE_OQ));
+    result = _mm256_or_ps(result, _mm256_and_ps(angle, sign));
+    if constexpr (Range == AngleRange::full) {
+      result = _mm256_blendv_ps(result, _mm256_add_ps(result, full), _mm256_cmp_ps(result, zero, _CMP_LT_OQ));
+    }
+    else {
+      const __m256 half = _mm256_set1_ps(180.0f);
+      const __m256 minus_half = _mm256_set1_ps(-180.0f);
+      const __m256 low = _mm256_cmp_ps(result, minus_half, _CMP_LT_OQ);
+      const __m256 high = _mm256_cmp_ps(result, half, _CMP_GE_OQ);
+      result = _mm256_blendv_ps(_mm256_blendv_ps(result, _mm256_sub_ps(result, full), high),
+          _mm256_add_ps(result, full), low);
+      if constexpr (Range == AngleRange::latitude) {
+        const __m256 quarter = _mm256_set1_ps(90.0f);
+        const __m256 minus_quarter = _mm256_set1_ps(-90.0f);
+        const __m256 north = _mm256_cmp_ps(result, quarter, _CMP_GT_OQ);
+        const __m256 south = _mm256_cmp_ps(result, minus_quarter, _CMP_LT_OQ);
+        result = _mm256_blendv_ps(_mm256_blendv_ps(result, _mm256_sub_ps(minus_half, result), south),
+            _mm256_sub_ps(half, result), north);
+      }
+    }
+    _mm256_storeu_ps(angles + i, result);
+  }
+  reduce_scalar<Range>(angles + i, size - i);
+}
+
+
+template <AngleRange Range>
+__attribute__((target("avx512f")))
+static void reduce_avx512(double* angles, const std::ptrdiff_t size) {
+  const __m512d full = _mm512_set1_pd(360.0);
+  const __m512d inverse = _mm512_set1_pd(1.0 / 360.0);
+  const __m512d zero = _mm512_setzero_pd();
+  const __m512i sign = _mm512_set1_epi64(static_cast<long long>(0x8000000000000000ULL));
+  const __m512d limit = _mm512_set1_pd(vector_limit);
+  std::ptrdiff_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const __m512d angle = _mm512_loadu_pd(angles + i);
+    const __m512d magnitude = _mm512_abs_pd(angle);
+    if (_mm512_cmp_pd_mask(magnitude, limit, _CMP_LT_OQ) != 0xFF) {
+      reduce_scalar<Range>(angles + i, 8);
+      continue;
+    }
+    const __m512d quotient = _mm512_roundscale_pd(_mm512_mul_pd(magnitude, inverse), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    __m512d result = _mm512_fnmadd_pd(quotient, full, magnitude);
+    result = _mm512_mask_add_pd(result, _mm512_cmp_pd_mask(result, zero, _CMP_LT_OQ), result, full);
+    result = _mm512_mask_sub_pd(result, _mm512_cmp_pd_mask(result, full, _CMP_GE_OQ), result, full);
+    result = _mm512_castsi512_pd(_mm512_or_si512(_mm512_castpd_si512(result),
+        _mm512_and_si512(_mm512_castpd_si512(angle), sign)));
+    if constexpr (Range == AngleRange::full) {
+      result = _mm512_mask_add_pd(result, _mm512_cmp_pd_mask(result, zero, _CMP_LT_OQ), result, full);
+    }
+    else {
+      const __m512d half = _mm512_set1_pd(180.0);
+      const __m512d minus_half = _mm512_set1_pd(-180.0);
+      const __mmask8 low = _mm512_cmp_pd_mask(result, minus_half, _CMP_LT_OQ);
+      const __mmask8 high = _mm512_cmp_pd_mask(result, half, _CMP_GE_OQ);
+      result = _mm512_mask_sub_pd(_mm512_mask_add_pd(result, low, result, full), high, result, full);
+      if constexpr (Range == AngleRange::latitude) {
+        const __mmask8 north = _mm512_cmp_pd_mask(result, _mm512_set1_pd(90.0), _CMP_GT_OQ);
+        const __mmask8 south = _mm512_cmp_pd_mask(result, _mm512_set1_pd(-90.0), _CMP_LT_OQ);
+        result = _mm512_mask_sub_pd(_mm512_mask_sub_pd(result, south, minus_half, result), north, half, result);
+      }
+    }
+    _mm512_storeu_pd(angles + i, result);
+  }
+  reduce_scalar<Range>(angles + i, size - i);
+}
+
+
+template <AngleRange Range>
+__attribute__((target("avx512f")))
+static void reduce_avx512(float* angles, const std::ptrdiff_t size) {
+  const __m512 full = _mm512_set1_ps(360.0f);
+  const __m512 inverse = _mm512_set1_ps(1.0f / 360.0f);
+  const __m512 zero = _mm512_setzero_ps();
+  const __m512i sign = _mm512_set1_epi32(static_cast<int>(0x80000000U));
+  const __m512 limit = _mm512_set1_ps(vector_limit_float);
+  std::ptrdiff_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    const __m512 angle = _mm512_loadu_ps(angles + i);
+    const __m512 magnitude = _mm512_abs_ps(angle);
+    if (_mm512_cmp_ps_mask(magnitude, limit, _CMP_LT_OQ) != 0xFFFF) {
+      reduce_scalar<Range>(angles + i, 16);
+      continue;
+    }
+    const __m512 quotient = _mm512_roundscale_ps(_mm512_mul_ps(magnitude, inverse), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    __m512 result = _mm512_fnmadd_ps(quotient, full, magnitude);
+    result = _mm512_mask_add_ps(result, _mm512_cmp_ps_mask(result, zero, _CMP_LT_OQ), result, full);
+    result = _mm512_mask_sub_ps(result, _mm512_cmp_ps_mask(result, full, _CMP_GE_OQ), result, full);
+    result = _mm512_castsi512_ps(_mm512_or_si512(_mm512_castps_si512(result),
+        _mm512_and_si512(_mm512_castps_si512(angle), sign)));
+    if constexpr (Range == AngleRange::full) {
+      result = _mm512_mask_add_ps(result, _mm512_cmp_ps_mask(result, zero, _CMP_LT_OQ), result, full);
+    }
+    else {
+      const __m512 half = _mm512_set1_ps(180.0f);
+      const __m512 minus_half = _mm512_set1_ps(-180.0f);
+      const __mmask16 low = _mm512_cmp_ps_mask(result, minus_half, _CMP_LT_OQ);
+      const __mmask16 high = _mm512_cmp_ps_mask(result, half, _CMP_GE_OQ);
+      result = _mm512_mask_sub_ps(_mm512_mask_add_ps(result, low, result, full), high, result, full);
+      if constexpr (Range == AngleRange::latitude) {
+        const __mmask16 north = _mm512_cmp_ps_mask(result, _mm512_set1_ps(90.0f), _CMP_GT_OQ);
+        const __mmask16 south = _mm512_cmp_ps_mask(result, _mm512_set1_ps(-90.0f), _CMP_LT_OQ);
+        result = _mm512_mask_sub_ps(_mm512_mask_sub_ps(result, south, minus_half, result), north, half, result);
+      }
+    }
+    _mm512_storeu_ps(angles + i, result);
+  }
+  reduce_scalar<Range>(angles + i, size - i);
+}
+
+#endif
+
+
+enum class Isa {
+  scalar,
+  avx2,
+  avx512
+};
+
+
+static Isa detect_isa() {
+#ifdef GEOFUN_X86_DISPATCH
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    return Isa::avx512;
+  }
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    return Isa::avx2;
+  }
+#endif
+  return Isa::scalar;
+}
+
+
+/**
+ * Reduce size angles in place, over threads, with the widest instruction set
+ * the CPU supports
+ */
+template <AngleRange Range, typename T>
+static void reduce_angles(T* angles, const std::ptrdiff_t size, const int threads) {
+  static const Isa isa = detect_isa();
+  // Memory bound, so only large arrays gain from more threads
+  parallel_for(size, threads, [&](const std::ptrdiff_t begin, const std::ptrdiff_t end) {
+    switch (isa) {
+#ifdef GEOFUN_X86_DISPATCH
+      case Isa::avx512:
+        reduce_avx512<Range>(angles + begin, end - begin);
+        break;
+      case Isa::avx2:
+        reduce_avx2<Range>(angles + begin, end - begin);
+        break;
+#endif
+      default:
+        reduce_scalar<Range>(angles + begin, end - begin);
+    }
+  }, 1 << 16);
+}
+
+
+void angle_mod_array(double* angles, const std::ptrdiff_t size, const int threads) {
+  reduce_angles<AngleRange::full>(angles, size, threads);
+}
+
+
+void angle_mod_array(float* angles, const std::ptrdiff_t size, const int threads) {
+  reduce_angles<AngleRange::full>(angles, size, threads);
+}
+
+
+void angle_mod_signed_array(double* angles, const std::ptrdiff_t size, const int threads) {
+  reduce_angles<AngleRange::half>(angles, size, threads);
+}
+
+
+void angle_mod_signed_array(float* angles, const std::ptrdiff_t size, const int threads) {
+  reduce_angles<AngleRange::half>(angles, size, threads);
+}
+
+
+void normalize_positions(double* latitudes, double* longitudes, const std::ptrdiff_t size, const int threads) {
+  reduce_angles<AngleRange::latitude>(latitudes, size, threads);
+  reduce_angles<AngleRange::half>(longitudes, size, threads);
+}
+
+
+void normalize_positions(float* latitudes, float* longitudes, const std::ptrdiff_t size, const int threads) {
+  reduce_angles<AngleRange::latitude>(latitudes, size, threads);
+  reduce_angles<AngleRange::half>(longitudes, size, threads);
+}
+
+}  // namespace geofun
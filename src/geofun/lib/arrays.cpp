@@ -0,0 +1,143 @@
+#include <geofun/arrays.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <geofun/stats.hpp>
+
+namespace geofun {
+
+size_t broadcast_size(const size_t size1, const size_t size2) {
+  if (size1 != size2 && size1 != 1 && size2 != 1) {
+    throw std::invalid_argument(fmt::format("Arrays of size {} and {} can't be combined", size1, size2));
+  }
+  return size1 == 1 ? size2 : size1;
+}
+
+
+size_t checked_index(int i, const size_t size, const char* name) {
+  i = i < 0 ? i + static_cast<int>(size) : i;
+  if (i < 0 || static_cast<size_t>(i) >= size) {
+    throw std::out_of_range(fmt::format("Index {} is out of range for {}", i, name));
+  }
+  return static_cast<size_t>(i);
+}
+
+
+VectorArray operator*(const double multiplier, const VectorArray& vectors) {
+  return vectors.operator*(multiplier);
+}
+
+
+VectorArray operator+(const double angle, const VectorArray& vectors) {
+  return vectors.operator+(angle);
+}
+
+
+VectorArray operator-(const double angle, const VectorArray& vectors) {
+  VectorArray result(vectors);
+  return result.transform([angle](const Vector& vector) { return angle - vector; });
+}
+
+
+PositionArray& PositionArray::operator+=(const VectorArray& vectors) {
+  GEOFUN_PROBE(position_array_add, std::max(size_, vectors.size()));
+  const gl::Rhumb& rhumb = get_wgs84().rhumb();
+  return offset(vectors, 1.0, [&](double lat, double lon, double azi, double dist, double& out_lat, double& out_lon) {
+    rhumb.Direct(lat, lon, azi, dist, out_lat, out_lon);
+  });
+}
+
+PositionArray& PositionArray::operator-=(const VectorArray& vectors) {
+  GEOFUN_PROBE(position_array_subtract, std::max(size_, vectors.size()));
+  const gl::Rhumb& rhumb = get_wgs84().rhumb();
+  return offset(vectors, -1.0, [&](double lat, double lon, double azi, double dist, double& out_lat, double& out_lon) {
+    rhumb.Direct(lat, lon, azi, dist, out_lat, out_lon);
+  });
+}
+
+PositionArray& PositionArray::operator*=(const VectorArray& vectors) {
+  GEOFUN_PROBE(position_array_multiply, std::max(size_, vectors.size()));
+  const gl::Geodesic& geodesic = get_wgs84().geodesic();
+  return offset(vectors, 1.0, [&](double lat, double lon, double azi, double dist, double& out_lat, double& out_lon) {
+    geodesic.Direct(lat, lon, azi, dist, out_lat, out_lon);
+  });
+}
+
+PositionArray& PositionArray::operator/=(const VectorArray& vectors) {
+  GEOFUN_PROBE(position_array_divide, std::max(size_, vectors.size()));
+  const gl::Geodesic& geodesic = get_wgs84().geodesic();
+  return offset(vectors, -1.0, [&](double lat, double lon, double azi, double dist, double& out_lat, double& out_lon) {
+    geodesic.Direct(lat, lon, azi, dist, out_lat, out_lon);
+  });
+}
+
+
+/**
+ * Get vectors from positions1 to positions2 using inverse solver kernel(latitude1, longitude1,
+ * latitude2, longitude2, azimuth, distance)
+ */
+template <typename Kernel>
+VectorArray position_differences(const PositionArray& positions2, const PositionArray& positions1, Kernel kernel) {
+  const size_t size = broadcast_size(positions1.size(), positions2.size());
+  const size_t step1 = positions1.size() == 1 ? 0 : 1;
+  const size_t step2 = positions2.size() == 1 ? 0 : 1;
+  VectorArray result(size);
+  const double* latitude1 = positions1.latitudes();
+  const double* longitude1 = positions1.longitudes();
+  const double* latitude2 = positions2.latitudes();
+  const double* longitude2 = positions2.longitudes();
+  double* azimuth = result.azimuths();
+  double* length = result.lengths();
+  parallel_for(size, 0, [&](const std::ptrdiff_t begin, const std::ptrdiff_t end) {
+    for (std::ptrdiff_t i = begin; i < end; ++i) {
+      kernel(latitude1[i * step1], longitude1[i * step1], latitude2[i * step2], longitude2[i * step2],
+          azimuth[i], length[i]);
+      azimuth[i] = angle_mod(azimuth[i]);
+    }
+  });
+  return result;
+}
+
+
+VectorArray operator-(const PositionArray& positions2, const PositionArray& positions1) {
+  GEOFUN_PROBE(position_array_loxo, std::max(positions1.size(), positions2.size()));
+  const gl::Rhumb& rhumb = get_wgs84().rhumb();
+  return position_differences(positions2, positions1,
+      [&](double lat1, double lon1, double lat2, double lon2, double& azi, double& dist) {
+        rhumb.Inverse(lat1, lon1, lat2, lon2, dist, azi);
+      });
+}
+
+
+VectorArray operator/(const PositionArray& positions2, const PositionArray& positions1) {
+  GEOFUN_PROBE(position_array_ortho, std::max(positions1.size(), positions2.size()));
+  const gl::Geodesic& geodesic = get_wgs84().geodesic();
+  return position_differences(positions2, positions1,
+      [&](double lat1, double lon1, double lat2, double lon2, double& azi, double& dist) {
+        double azi2;
+        geodesic_inverse_kernel<output_distance | output_azimuth>(geodesic, lat1, lon1, lat2, lon2, dist, azi, azi2);
+      });
+}
+
+
+VectorArray operator-(const PositionArray& positions2, const Position& position1) {
+  return positions2 - PositionArray(position1);
+}
+
+
+VectorArray operator-(const Position& position2, const PositionArray& positions1) {
+  return PositionArray(position2) - positions1;
+}
+
+
+VectorArray operator/(const PositionArray& positions2, const Position& position1) {
+  return positions2 / PositionArray(position1);
+}
+
+
+VectorArray operator/(const Position& position2, const PositionArray& positions1) {
+  return PositionArray(position2) / positions1;
+}
+
+}  // namespace geofun
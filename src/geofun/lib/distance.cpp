@@ -0,0 +1,31 @@
+#include <geofun/distance.hpp>
+
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+namespace geofun {
+
+Metric get_metric(const std::string& name) {
+  if (name == "geodesic") {
+    return Metric::geodesic;
+  }
+  if (name == "rhumb") {
+    return Metric::rhumb;
+  }
+  if (name == "haversine") {
+    return Metric::haversine;
+  }
+  throw std::invalid_argument(fmt::format("Invalid metric: \"{}\"", name));
+}
+
+
+Metric get_leg_metric(const std::string& name) {
+  const Metric metric = get_metric(name);
+  if (metric == Metric::haversine) {
+    throw std::invalid_argument("Leg metric should be \"geodesic\" or \"rhumb\"");
+  }
+  return metric;
+}
+
+}  // namespace geofun
@@ -0,0 +1,116 @@
+#include <geofun/ellipsoid.hpp>
+
+#include <map>
+#include <mutex>
+#include <utility>
+
+#include <GeographicLib/Constants.hpp>
+
+#include <fmt/format.h>
+
+#include <geofun/angles.hpp>
+#include <geofun/stats.hpp>
+
+namespace geofun {
+
+std::string Ellipsoid::get_representation() const {
+  return fmt::format("Ellipsoid({}, {})", get_equatorial_radius(), get_flattening());
+}
+
+
+std::shared_ptr<const gl::Rhumb> Ellipsoid::get_rhumb(const double equatorial_radius, const double flattening) {
+  static std::mutex mutex;
+  static std::map<std::pair<double, double>, std::shared_ptr<const gl::Rhumb>> cache;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& rhumb = cache[{equatorial_radius, flattening}];
+  if (!rhumb) {
+    // Series expansion like gl::Rhumb::WGS84() uses
+    rhumb = std::make_shared<const gl::Rhumb>(equatorial_radius, flattening, false);
+  }
+  return rhumb;
+}
+
+
+const Ellipsoid& get_wgs84() {
+  // Never destroyed, so it stays valid in static destructors too
+  static const Ellipsoid* wgs84 = new Ellipsoid(gl::Constants::WGS84_a(), gl::Constants::WGS84_f());
+  return *wgs84;
+}
+
+
+std::tuple<double, double, double> rhumb_direct(
+    const double latitude, const double longitude, const double azimuth, const double distance,
+    const Ellipsoid* ellipsoid) {
+  GEOFUN_PROBE(rhumb_direct);
+  const gl::Rhumb& rhumb = get_ellipsoid(ellipsoid).rhumb();
+  double out_latitude;
+  double out_longitude;
+  rhumb.Direct(latitude, longitude, azimuth, distance, out_latitude, out_longitude);
+  return {out_latitude, out_longitude, azimuth};
+}
+
+
+std::tuple<double, double, double> rhumb_inverse(
+    const double latitude1, const double longitude1, const double latitude2, const double longitude2,
+    const Ellipsoid* ellipsoid) {
+  GEOFUN_PROBE(rhumb_inverse);
+  const gl::Rhumb& rhumb = get_ellipsoid(ellipsoid).rhumb();
+  double azimuth;
+  double distance;
+  rhumb.Inverse(latitude1, longitude1, latitude2, longitude2, distance, azimuth);
+  return {azimuth, distance, azimuth};
+}
+
+
+std::tuple<double, double, double> geodesic_direct(
+    const double latitude, const double longitude, const double azimuth, const double distance,
+    const Ellipsoid* ellipsoid) {
+  GEOFUN_PROBE(geodesic_direct);
+  const gl::Geodesic& geodesic = get_ellipsoid(ellipsoid).geodesic();
+  double out_latitude;
+  double out_longitude;
+  double out_azimuth;
+  geodesic.Direct(latitude, longitude, azimuth, distance, out_latitude, out_longitude, out_azimuth);
+  return {out_latitude, out_longitude, out_azimuth};
+}
+
+
+std::tuple<double, double, double> geodesic_inverse(
+    const double latitude1, const double longitude1, const double latitude2, const double longitude2,
+    const Ellipsoid* ellipsoid) {
+  GEOFUN_PROBE(geodesic_inverse);
+  const gl::Geodesic& geodesic = get_ellipsoid(ellipsoid).geodesic();
+  double azimuth1;
+  double distance;
+  double azimuth2;
+  geodesic.Inverse(latitude1, longitude1, latitude2, longitude2, distance, azimuth1, azimuth2);
+  return {azimuth1, distance, azimuth2};
+}
+
+
+/**
+ * Get e atanh(e x) for signed eccentricity e. With the imaginary eccentricity
+ * of a prolate ellipsoid, that is -|e| atan(|e| x).
+ */
+static double eatanhe(const double x, const double eccentricity) {
+  return eccentricity > 0.0
+      ? eccentricity * std::atanh(eccentricity * x)
+      : -eccentricity * std::atan(eccentricity * x);
+}
+
+
+double isometric_latitude(const double latitude, const double eccentricity) {
+  const double phi = d2r * latitude;
+  return std::asinh(std::tan(phi)) - eatanhe(std::sin(phi), eccentricity);
+}
+
+
+double inverse_isometric_latitude(const double isometric, const double eccentricity) {
+  double phi = std::atan(std::sinh(isometric));
+  for (int i = 0; i < 8; ++i) {
+    phi = std::atan(std::sinh(isometric + eatanhe(std::sin(phi), eccentricity)));
+  }
+  return r2d * phi;
+}
+
+}  // namespace geofun
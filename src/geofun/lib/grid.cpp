@@ -0,0 +1,125 @@
+#include <geofun/grid.hpp>
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include <GeographicLib/Geohash.hpp>
+#include <GeographicLib/MGRS.hpp>
+#include <GeographicLib/UTMUPS.hpp>
+
+#include <fmt/format.h>
+
+namespace geofun {
+
+namespace gl = GeographicLib;
+
+
+bool utm_forward(const double latitude, const double longitude, int& zone, bool& north, double& easting,
+    double& northing) {
+  try {
+    gl::UTMUPS::Forward(latitude, longitude, zone, north, easting, northing);
+    return true;
+  }
+  catch (const gl::GeographicErr&) {
+    zone = gl::UTMUPS::INVALID;
+    north = false;
+    easting = northing = std::numeric_limits<double>::quiet_NaN();
+    return false;
+  }
+}
+
+
+bool utm_reverse(const int zone, const bool north, const double easting, const double northing, double& latitude,
+    double& longitude) {
+  try {
+    gl::UTMUPS::Reverse(zone, north, easting, northing, latitude, longitude);
+    return true;
+  }
+  catch (const gl::GeographicErr&) {
+    latitude = longitude = std::numeric_limits<double>::quiet_NaN();
+    return false;
+  }
+}
+
+
+void check_mgrs_precision(const int precision) {
+  if (precision < 0 || precision > 11) {
+    throw std::invalid_argument(fmt::format("Invalid MGRS precision: {}", precision));
+  }
+}
+
+
+bool mgrs_forward(const double latitude, const double longitude, const int precision, std::string& code) {
+  int zone;
+  bool north;
+  double x;
+  double y;
+  if (!utm_forward(latitude, longitude, zone, north, x, y) || zone == gl::UTMUPS::INVALID) {
+    return false;
+  }
+  try {
+    gl::MGRS::Forward(zone, north, x, y, latitude, precision, code);
+    return true;
+  }
+  catch (const gl::GeographicErr&) {
+    return false;
+  }
+}
+
+
+bool mgrs_reverse(const std::string& code, double& latitude, double& longitude) {
+  int zone;
+  bool north;
+  double x;
+  double y;
+  int precision;
+  try {
+    gl::MGRS::Reverse(code, zone, north, x, y, precision);
+  }
+  catch (const gl::GeographicErr&) {
+    return false;
+  }
+  if (zone == gl::UTMUPS::INVALID) {
+    return false;
+  }
+  return utm_reverse(zone, north, x, y, latitude, longitude);
+}
+
+
+void check_geohash_length(const int length) {
+  if (length < 1 || length > 18) {
+    throw std::invalid_argument(fmt::format("Invalid geohash length: {}", length));
+  }
+}
+
+
+bool geohash_forward(const double latitude, const double longitude, const int length, std::string& code) {
+  if (std::isnan(latitude) || std::isnan(longitude)) {
+    return false;
+  }
+  try {
+    gl::Geohash::Forward(latitude, longitude, length, code);
+    return true;
+  }
+  catch (const gl::GeographicErr&) {
+    return false;
+  }
+}
+
+
+bool geohash_reverse(const std::string& code, double& latitude, double& longitude) {
+  if (code.empty()) {
+    return false;
+  }
+  int length;
+  try {
+    gl::Geohash::Reverse(code, latitude, longitude, length);
+  }
+  catch (const gl::GeographicErr&) {
+    return false;
+  }
+  return !std::isnan(latitude);
+}
+
+}  // namespace geofun
@@ -0,0 +1,179 @@
+#include <geofun/index.hpp>
+
+#include <algorithm>
+#include <functional>
+
+namespace geofun {
+
+UnitVector unit_vector(const double latitude, const double longitude) {
+  const double cos_latitude = std::cos(d2r * latitude);
+  return {
+    cos_latitude * std::cos(d2r * longitude),
+    cos_latitude * std::sin(d2r * longitude),
+    std::sin(d2r * latitude)
+  };
+}
+
+
+double chord_angle(const double chord) {
+  return 2.0 * std::asin(std::min(0.5 * chord, 1.0));
+}
+
+
+double chord_length(const UnitVector& vector1, const UnitVector& vector2) {
+  const double dx = vector1[0] - vector2[0];
+  const double dy = vector1[1] - vector2[1];
+  const double dz = vector1[2] - vector2[2];
+  return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+
+void PositionIndex::nearest(const double latitude, const double longitude, const std::ptrdiff_t count,
+    int64_t* indices, double* distances) const {
+  using Candidate = std::pair<double, std::ptrdiff_t>;
+  std::vector<Candidate> best;
+  best.reserve(count + 1);
+  auto worst = [&]() {
+    return static_cast<std::ptrdiff_t>(best.size()) < count ? inf : best.front().first;
+  };
+  if (!nodes_.empty() && count > 0) {
+    const UnitVector point = unit_vector(latitude, longitude);
+    std::vector<Candidate> queue{{lower_bound(nodes_[0], point), 0}};
+    while (!queue.empty()) {
+      std::pop_heap(queue.begin(), queue.end(), std::greater<Candidate>());
+      const auto [bound, n] = queue.back();
+      queue.pop_back();
+      if (bound >= worst()) {
+        break;
+      }
+      const Node& node = nodes_[n];
+      if (node.left < 0) {
+        for (std::ptrdiff_t i = node.begin; i < node.end; ++i) {
+          if (lower_bound(i, point) >= worst()) {
+            continue;
+          }
+          const double distance = geodesic_distance(i, latitude, longitude);
+          if (distance < worst()) {
+            best.emplace_back(distance, i);
+            std::push_heap(best.begin(), best.end());
+            if (static_cast<std::ptrdiff_t>(best.size()) > count) {
+              std::pop_heap(best.begin(), best.end());
+              best.pop_back();
+            }
+          }
+        }
+      }
+      else {
+        for (auto child: {node.left, node.right}) {
+          const double child_bound = lower_bound(nodes_[child], point);
+          if (child_bound < worst()) {
+            queue.emplace_back(child_bound, child);
+            std::push_heap(queue.begin(), queue.end(), std::greater<Candidate>());
+          }
+        }
+      }
+    }
+  }
+  std::sort_heap(best.begin(), best.end());
+  for (std::ptrdiff_t i = 0; i < count; ++i) {
+    const bool found = i < static_cast<std::ptrdiff_t>(best.size());
+    indices[i] = found ? indices_[best[i].second] : -1;
+    distances[i] = found ? best[i].first : inf;
+  }
+}
+
+
+void PositionIndex::within(const double latitude, const double longitude, const double radius,
+    std::vector<std::pair<double, int64_t>>& result) const {
+  const size_t first = result.size();
+  if (!nodes_.empty()) {
+    const UnitVector point = unit_vector(latitude, longitude);
+    std::vector<int> stack{0};
+    while (!stack.empty()) {
+      const Node& node = nodes_[stack.back()];
+      stack.pop_back();
+      if (lower_bound(node, point) > radius) {
+        continue;
+      }
+      if (node.left < 0) {
+        for (std::ptrdiff_t i = node.begin; i < node.end; ++i) {
+          if (lower_bound(i, point) > radius) {
+            continue;
+          }
+          const double distance = geodesic_distance(i, latitude, longitude);
+          if (distance <= radius) {
+            result.emplace_back(distance, indices_[i]);
+          }
+        }
+      }
+      else {
+        stack.push_back(node.left);
+        stack.push_back(node.right);
+      }
+    }
+  }
+  std::sort(result.begin() + first, result.end());
+}
+
+
+void PositionIndex::build_tree() {
+  const std::ptrdiff_t size = latitudes_.size();
+  indices_.resize(size);
+  points_.resize(size);
+  std::vector<std::ptrdiff_t> order(size);
+  for (std::ptrdiff_t i = 0; i < size; ++i) {
+    order[i] = i;
+    points_[i] = unit_vector(latitudes_[i], longitudes_[i]);
+  }
+  if (size > 0) {
+    build(order, 0, size);
+  }
+  // Store everything in tree order
+  std::vector<double> latitudes(size);
+  std::vector<double> longitudes(size);
+  std::vector<UnitVector> points(size);
+  for (std::ptrdiff_t i = 0; i < size; ++i) {
+    indices_[i] = order[i];
+    latitudes[i] = latitudes_[order[i]];
+    longitudes[i] = longitudes_[order[i]];
+    points[i] = points_[order[i]];
+  }
+  latitudes_.swap(latitudes);
+  longitudes_.swap(longitudes);
+  points_.swap(points);
+}
+
+
+int PositionIndex::build(std::vector<std::ptrdiff_t>& order, const std::ptrdiff_t begin, const std::ptrdiff_t end) {
+  Node node{points_[order[begin]], points_[order[begin]], begin, end, -1, -1};
+  for (std::ptrdiff_t i = begin + 1; i < end; ++i) {
+    const UnitVector& point = points_[order[i]];
+    for (int d = 0; d < 3; ++d) {
+      node.min[d] = std::min(node.min[d], point[d]);
+      node.max[d] = std::max(node.max[d], point[d]);
+    }
+  }
+  const int n = static_cast<int>(nodes_.size());
+  nodes_.push_back(node);
+  if (end - begin > leaf_size) {
+    // Split at the median of the widest dimension
+    int dimension = 0;
+    for (int d = 1; d < 3; ++d) {
+      if (node.max[d] - node.min[d] > node.max[dimension] - node.min[dimension]) {
+        dimension = d;
+      }
+    }
+    const std::ptrdiff_t middle = begin + (end - begin) / 2;
+    std::nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end,
+        [&](const std::ptrdiff_t i, const std::ptrdiff_t j) {
+          return points_[i][dimension] < points_[j][dimension];
+        });
+    const int left = build(order, begin, middle);
+    const int right = build(order, middle, end);
+    nodes_[n].left = left;
+    nodes_[n].right = right;
+  }
+  return n;
+}
+
+}  // namespace geofun
@@ -0,0 +1,116 @@
+#include <geofun/intersect.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include <geofun/angles.hpp>
+
+namespace geofun {
+
+Box SegmentIntersector::get_box(const double latitude1, const double longitude1, const double latitude2,
+    const double longitude2) const {
+  // Bounds are widened a bit against rounding
+  const double margin = 1e-9;
+  Box box;
+  box.south = std::min(latitude1, latitude2) - margin;
+  box.north = std::max(latitude1, latitude2) + margin;
+  box.west = angle_mod_signed(longitude1);
+  box.east = box.west + angle_mod_signed(longitude2 - longitude1);
+  if (box.east < box.west) {
+    std::swap(box.west, box.east);
+  }
+  box.west -= margin;
+  box.east += margin;
+  if (kind_ == LineKind::ortho) {
+    double distance;
+    double azimuth1;
+    double azimuth2;
+    geodesic_.Inverse(latitude1, longitude1, latitude2, longitude2, distance, azimuth1, azimuth2);
+    const double cos1 = std::cos(d2r * azimuth1);
+    const double cos2 = std::cos(d2r * azimuth2);
+    if ((cos1 > 0.0) != (cos2 > 0.0)) {
+      // Clairaut: the sine of the azimuth at the equator gives the reduced latitude of the vertex
+      const double one_minus_f = 1.0 - geodesic_.Flattening();
+      const double reduced1 = std::atan(one_minus_f * std::tan(d2r * latitude1));
+      const double sin_azimuth0 = std::sin(d2r * azimuth1) * std::cos(reduced1);
+      const double reduced0 = std::acos(std::min(std::fabs(sin_azimuth0), 1.0));
+      const double vertex = r2d * std::atan(std::tan(reduced0) / one_minus_f) + margin;
+      if (cos1 > 0.0) {
+        box.north = std::max(box.north, vertex);
+      }
+      else {
+        box.south = std::min(box.south, -vertex);
+      }
+      if (vertex >= 90.0) {
+        // Over the pole, every longitude is on the segment
+        box.west = -180.0;
+        box.east = 180.0;
+      }
+    }
+  }
+  return box;
+}
+
+
+bool SegmentIntersector::intersection(const double latitude1, const double longitude1, const double latitude2, const double longitude2,
+    const double latitude3, const double longitude3, const double latitude4, const double longitude4,
+    double& latitude, double& longitude) const {
+  if (kind_ == LineKind::ortho) {
+    int segment_mode;
+    const gl::Intersect::Point point = intersect_.Segment(latitude1, longitude1, latitude2, longitude2,
+        latitude3, longitude3, latitude4, longitude4, segment_mode);
+    if (segment_mode != 0) {
+      return false;
+    }
+    geodesic_.InverseLine(latitude1, longitude1, latitude2, longitude2, ortho_line_caps)
+        .Position(point.first, latitude, longitude);
+    return true;
+  }
+  // Longitudes unwrapped relative to position 1
+  const double x1 = longitude1;
+  const double x2 = x1 + angle_mod_signed(longitude2 - longitude1);
+  const double x3 = x1 + angle_mod_signed(longitude3 - longitude1);
+  const double x4 = x3 + angle_mod_signed(longitude4 - longitude3);
+  const double y1 = isometric_latitude(latitude1, eccentricity_);
+  const double y2 = isometric_latitude(latitude2, eccentricity_);
+  const double y3 = isometric_latitude(latitude3, eccentricity_);
+  const double y4 = isometric_latitude(latitude4, eccentricity_);
+  const double dx1 = x2 - x1;
+  const double dy1 = y2 - y1;
+  const double dx2 = x4 - x3;
+  const double dy2 = y4 - y3;
+  const double denominator = dx1 * dy2 - dy1 * dx2;
+  if (denominator == 0.0) {
+    return false;
+  }
+  // The second segment may overlap the first one a turn of longitude further
+  for (const double shift: {0.0, -360.0, 360.0}) {
+    const double ex = x3 + shift - x1;
+    const double ey = y3 - y1;
+    const double t = (ex * dy2 - ey * dx2) / denominator;
+    const double u = (ex * dy1 - ey * dx1) / denominator;
+    if (t >= 0.0 && t <= 1.0 && u >= 0.0 && u <= 1.0) {
+      latitude = inverse_isometric_latitude(y1 + t * dy1, eccentricity_);
+      longitude = angle_mod_signed(x1 + t * dx1);
+      return true;
+    }
+  }
+  return false;
+}
+
+
+std::optional<Position> intersection(const Position& start1, const Position& end1, const Position& start2,
+    const Position& end2, const std::string& kind, const Ellipsoid* ellipsoid) {
+  const SegmentIntersector intersector(get_ellipsoid(ellipsoid), get_line_kind(kind));
+  double latitude;
+  double longitude;
+  if (!intersector.intersection(start1.get_latitude(), start1.get_longitude(), end1.get_latitude(),
+      end1.get_longitude(), start2.get_latitude(), start2.get_longitude(), end2.get_latitude(),
+      end2.get_longitude(), latitude, longitude)) {
+    return std::nullopt;
+  }
+  return Position(latitude, longitude);
+}
+
+}  // namespace geofun
@@ -0,0 +1,175 @@
+#include <geofun/lines.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include <geofun/parallel.hpp>
+
+namespace geofun {
+
+gl::GeodesicLine ortho_line(const Vector& vector, const Position& start, const Ellipsoid& ellipsoid) {
+  return ellipsoid.geodesic().DirectLine(
+      start.get_latitude(), start.get_longitude(), vector.get_azimuth(), vector.get_length(),
+      gl::Geodesic::LATITUDE | gl::Geodesic::LONGITUDE | gl::Geodesic::DISTANCE_IN);
+}
+
+
+gl::RhumbLine loxo_line(const Vector& vector, const Position& start, const Ellipsoid& ellipsoid) {
+  return ellipsoid.rhumb().Line(start.get_latitude(), start.get_longitude(), vector.get_azimuth());
+}
+
+
+LineKind get_line_kind(const std::string& name) {
+  if (name == "ortho") {
+    return LineKind::ortho;
+  }
+  if (name == "loxo") {
+    return LineKind::loxo;
+  }
+  throw std::invalid_argument(fmt::format("Invalid line kind: \"{}\"", name));
+}
+
+
+Intercept line_intercept(const Ellipsoid& ellipsoid, const LineKind kind,
+    const double start_latitude, const double start_longitude, const double end_latitude, const double end_longitude,
+    const double latitude, const double longitude) {
+  const gl::Geodesic& geodesic = ellipsoid.geodesic();
+  if (kind == LineKind::ortho) {
+    const OrthoLine line(geodesic.InverseLine(start_latitude, start_longitude, end_latitude, end_longitude, ortho_line_caps));
+    return intercept(line, geodesic, latitude, longitude);
+  }
+  double distance;
+  double azimuth;
+  ellipsoid.rhumb().Inverse(start_latitude, start_longitude, end_latitude, end_longitude, distance, azimuth);
+  const LoxoLine line(ellipsoid.rhumb().Line(start_latitude, start_longitude, azimuth));
+  return intercept(line, geodesic, latitude, longitude);
+}
+
+
+std::tuple<double, double> cross_track(const Position& start, const Position& end, const Position& position,
+    const std::string& kind, const Ellipsoid* ellipsoid) {
+  const Intercept result = line_intercept(get_ellipsoid(ellipsoid), get_line_kind(kind),
+      start.get_latitude(), start.get_longitude(), end.get_latitude(), end.get_longitude(),
+      position.get_latitude(), position.get_longitude());
+  return {result.cross, result.along};
+}
+
+
+std::tuple<double, double> closest_approach(const gl::Geodesic& geodesic,
+    const double latitude1, const double longitude1, const double course1, const double speed1,
+    const double latitude2, const double longitude2, const double course2, const double speed2) {
+  double distance;
+  double azimuth1;
+  double azimuth2;
+  geodesic.Inverse(latitude1, longitude1, latitude2, longitude2, distance, azimuth1, azimuth2);
+  const Vector offset(azimuth1, distance);
+  const Vector velocity1(course1, speed1);
+  const Vector velocity2(course2 + azimuth1 - azimuth2, speed2);
+  const double x = offset.get_x();
+  const double y = offset.get_y();
+  const double vx = velocity2.get_x() - velocity1.get_x();
+  const double vy = velocity2.get_y() - velocity1.get_y();
+  // Relative speeds below a nanometer per second are rounding errors
+  static constexpr double min_squared_speed = 1E-18;
+  const double squared_speed = vx * vx + vy * vy;
+  const double time = squared_speed > min_squared_speed ? -(x * vx + y * vy) / squared_speed : 0.0;
+  return {time, std::hypot(x + vx * time, y + vy * time)};
+}
+
+
+std::tuple<double, double> cpa(const Position& position1, const Vector& velocity1,
+    const Position& position2, const Vector& velocity2, const Ellipsoid* ellipsoid) {
+  return closest_approach(get_ellipsoid(ellipsoid).geodesic(),
+      position1.get_latitude(), position1.get_longitude(), velocity1.get_azimuth(), velocity1.get_length(),
+      position2.get_latitude(), position2.get_longitude(), velocity2.get_azimuth(), velocity2.get_length());
+}
+
+
+double segment_distance(const OrthoLine& line, const double length, const gl::Geodesic& geodesic,
+    const double latitude, const double longitude, double& along) {
+  if (length > 0.0) {
+    const Intercept closest = intercept(line, geodesic, latitude, longitude, along);
+    along = closest.along;
+    if (along > 0.0 && along < length) {
+      return std::fabs(closest.cross);
+    }
+  }
+  double end_latitude;
+  double end_longitude;
+  double end_azimuth;
+  line.position(along > 0.0 ? length : 0.0, end_latitude, end_longitude, end_azimuth);
+  double distance;
+  geodesic.Inverse(end_latitude, end_longitude, latitude, longitude, distance);
+  return distance;
+}
+
+
+void simplify_track(const double* latitude, const double* longitude, const std::ptrdiff_t begin, const std::ptrdiff_t end,
+    const double tolerance, const gl::Geodesic& geodesic, std::vector<int64_t>& kept) {
+  std::vector<bool> keep(end - begin, false);
+  keep.front() = keep.back() = true;
+  std::vector<std::pair<std::ptrdiff_t, std::ptrdiff_t>> ranges{{begin, end - 1}};
+  while (!ranges.empty()) {
+    const auto [first, last] = ranges.back();
+    ranges.pop_back();
+    if (last - first < 2) {
+      continue;
+    }
+    const OrthoLine line(geodesic.InverseLine(
+        latitude[first], longitude[first], latitude[last], longitude[last], ortho_line_caps));
+    const double length = line.line.Distance();
+    double max_distance = -1.0;
+    std::ptrdiff_t farthest = first;
+    // Records are ordered along the segment, so the intercept of one is a good start for the next
+    double along = 0.0;
+    for (std::ptrdiff_t i = first + 1; i < last; ++i) {
+      const double distance = segment_distance(line, length, geodesic, latitude[i], longitude[i], along);
+      if (distance > max_distance) {
+        max_distance = distance;
+        farthest = i;
+      }
+    }
+    if (max_distance > tolerance) {
+      keep[farthest - begin] = true;
+      ranges.emplace_back(first, farthest);
+      ranges.emplace_back(farthest, last);
+    }
+  }
+  for (std::ptrdiff_t i = begin; i < end; ++i) {
+    if (keep[i - begin]) {
+      kept.push_back(i);
+    }
+  }
+}
+
+
+std::vector<int64_t> simplify_tracks(const double* latitude, const double* longitude, const std::ptrdiff_t size,
+    const double tolerance, const int64_t* id, const int threads, const Ellipsoid& ellipsoid) {
+  if (!(tolerance >= 0.0)) {
+    throw std::invalid_argument(fmt::format("Invalid tolerance: {}", tolerance));
+  }
+  std::vector<std::pair<std::ptrdiff_t, std::ptrdiff_t>> tracks;
+  for (std::ptrdiff_t i = 0; i < size; ++i) {
+    if (i == 0 || (id != nullptr && id[i] != id[i - 1])) {
+      tracks.emplace_back(i, i);
+    }
+    tracks.back().second = i + 1;
+  }
+  std::vector<std::vector<int64_t>> kept(tracks.size());
+  const gl::Geodesic& geodesic = ellipsoid.geodesic();
+  parallel_for(tracks.size(), threads, [&](const std::ptrdiff_t begin, const std::ptrdiff_t end) {
+    for (std::ptrdiff_t i = begin; i < end; ++i) {
+      simplify_track(latitude, longitude, tracks[i].first, tracks[i].second, tolerance, geodesic, kept[i]);
+    }
+  }, 1);
+  std::vector<int64_t> result;
+  for (const auto& track: kept) {
+    result.insert(result.end(), track.begin(), track.end());
+  }
+  return result;
+}
+
+}  // namespace geofun
@@ -0,0 +1,123 @@
+#include <geofun/parallel.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <fmt/format.h>
+
+namespace geofun {
+
+/**
+ * Number of threads used by batch operations when not specified per call.
+ * Zero means one thread per hardware core.
+ */
+static std::atomic<int> default_threads{0};
+
+
+int get_threads() {
+  int threads = default_threads.load();
+  if (threads <= 0) {
+    threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  }
+  return threads;
+}
+
+
+void set_threads(const int threads) {
+  if (threads < 0) {
+    throw std::invalid_argument(fmt::format("Invalid thread count: {}", threads));
+  }
+  default_threads = threads;
+}
+
+
+
+/**
+ * Call of run_on_threads: pool threads may still start tickets of it and
+ * running counts the pool threads that are in task
+ */
+struct Job {
+  const std::function<void()>* task;
+  int tickets;
+  int running;
+};
+
+
+/**
+ * Threads waiting for tickets of jobs
+ */
+struct ThreadPool {
+  std::mutex mutex;
+  std::condition_variable work;
+  std::condition_variable done;
+  std::deque<Job*> jobs;
+  std::vector<std::thread> threads;
+};
+
+
+static ThreadPool& get_pool() {
+  // Never destroyed, as the threads keep waiting until the process exits
+  static ThreadPool* pool = new ThreadPool();
+  return *pool;
+}
+
+
+static thread_local bool in_pool = false;
+
+
+static void run_pool_thread(ThreadPool& pool) {
+  in_pool = true;
+  std::unique_lock<std::mutex> lock(pool.mutex);
+  while (true) {
+    pool.work.wait(lock, [&]() { return !pool.jobs.empty(); });
+    Job* job = pool.jobs.front();
+    if (--job->tickets == 0) {
+      pool.jobs.pop_front();
+    }
+    ++job->running;
+    lock.unlock();
+    (*job->task)();
+    lock.lock();
+    if (--job->running == 0 && job->tickets == 0) {
+      pool.done.notify_all();
+    }
+  }
+}
+
+
+void run_on_threads(const int threads, const std::function<void()>& task) {
+  if (threads <= 1 || in_pool) {
+    task();
+    return;
+  }
+  ThreadPool& pool = get_pool();
+  Job job{&task, threads - 1, 0};
+  {
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    try {
+      while (pool.threads.size() < static_cast<size_t>(threads - 1)) {
+        pool.threads.emplace_back(run_pool_thread, std::ref(pool));
+      }
+    }
+    catch (const std::system_error&) {
+      // Do with the threads there are
+    }
+    pool.jobs.push_back(&job);
+  }
+  pool.work.notify_all();
+  task();
+  std::unique_lock<std::mutex> lock(pool.mutex);
+  if (job.tickets > 0) {
+    // Not started, as the pool threads are busy
+    job.tickets = 0;
+    pool.jobs.erase(std::find(pool.jobs.begin(), pool.jobs.end(), &job));
+  }
+  pool.done.wait(lock, [&]() { return job.running == 0; });
+}
+
+}  // namespace geofun
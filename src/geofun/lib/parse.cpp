@@ -0,0 +1,239 @@
+#include <geofun/parse.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+namespace geofun {
+
+bool parse_dms(const std::string_view latitude, const std::string_view longitude, Position& position, int& count) {
+  double values[6];
+  bool is_integral = true;
+  const size_t latitude_count = scan_floats(latitude, values, 6, is_integral);
+  const size_t stored = std::min(latitude_count, size_t(6));
+  count = static_cast<int>(latitude_count + scan_floats(longitude, values + stored, 6 - stored, is_integral));
+  int i_count = count / 2;
+  if ((count == 0) || (count % 2) || (i_count > 3)) {
+    return false;
+  }
+  size_t pos_N = latitude.find('N');
+  size_t pos_S = latitude.find('S');
+  bool is_south = pos_S != std::string_view::npos;
+  bool single = longitude.empty();
+  size_t pos_E = single ? latitude.find('E') : longitude.find('E');
+  size_t pos_W = single ? latitude.find('W') : longitude.find('W');
+  bool is_west = pos_W != std::string_view::npos;
+  size_t pos_la = std::min(pos_N, pos_S);
+  size_t pos_lo = std::min(pos_E, pos_W);
+  bool reversed = single ? pos_lo < pos_la : false;
+
+  int offset = reversed ? i_count : 0;
+  double value = values[offset];
+  double lat = is_south ? -value : value;
+  double mult = std::signbit(lat) ? (-1.0 / 60.0) : (1.0 / 60.0);
+  int i = 1;
+  while (i < i_count) {
+    value = values[offset + i++];
+    lat += value * mult;
+    mult /= 60.0;
+  }
+
+  offset = reversed ? 0 : i_count;
+  value = values[offset];
+  double lon = is_west ? -value : value;
+  mult = std::signbit(lon) ? (-1.0 / 60.0) : (1.0 / 60.0);
+  i = 1;
+  while (i < i_count) {
+    value = values[offset + i++];
+    lon += value * mult;
+    mult /= 60.0;
+  }
+
+  if (is_integral) {
+    position.set_latitude_seconds(static_cast<int>(lat));
+    position.set_longitude_seconds(static_cast<int>(lon));
+  }
+  else {
+    position.set_latitude(lat);
+    position.set_longitude(lon);
+  }
+  return true;
+}
+
+
+bool parse_nmea_angle(const std::string_view field, const std::string_view hemisphere,
+    const char positive, const char negative, const double limit, double& angle) {
+  double value;
+  if (field.empty() || !is_digit(field.front()) || scan_float(field, value) != field.size()
+      || hemisphere.size() != 1 || (hemisphere[0] != positive && hemisphere[0] != negative)) {
+    return false;
+  }
+  const double degrees = std::floor(value / 100.0);
+  const double minutes = value - 100.0 * degrees;
+  angle = degrees + minutes / 60.0;
+  if (minutes >= 60.0 || angle > limit) {
+    return false;
+  }
+  angle = hemisphere[0] == negative ? -angle : angle;
+  return true;
+}
+
+
+bool parse_nmea(const std::string_view text, Position& position) {
+  std::string_view fields[4];
+  size_t count = 0;
+  size_t begin = 0;
+  while (count < 4) {
+    const size_t end = text.find(',', begin);
+    fields[count++] = trim(text.substr(begin, end == std::string_view::npos ? end : end - begin));
+    if (end == std::string_view::npos) {
+      break;
+    }
+    begin = end + 1;
+    if (count == 4) {
+      return false;
+    }
+  }
+  double latitude;
+  double longitude;
+  if (count != 4
+      || !parse_nmea_angle(fields[0], fields[1], 'N', 'S', 90.0, latitude)
+      || !parse_nmea_angle(fields[2], fields[3], 'E', 'W', 180.0, longitude)) {
+    return false;
+  }
+  position.set_latitude(latitude);
+  position.set_longitude(longitude);
+  return true;
+}
+
+
+PositionFormat get_position_format(const std::string& name) {
+  if (name == "dms") {
+    return PositionFormat::dms;
+  }
+  if (name == "nmea") {
+    return PositionFormat::nmea;
+  }
+  throw std::invalid_argument(fmt::format("Invalid position format: \"{}\"", name));
+}
+
+
+int64_t days_from_civil(int64_t year, const unsigned month, const unsigned day) {
+  year -= month <= 2;
+  const int64_t era = (year >= 0 ? year : year - 399) / 400;
+  const unsigned year_of_era = static_cast<unsigned>(year - era * 400);
+  const unsigned day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+  const unsigned day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+  return era * 146097 + static_cast<int64_t>(day_of_era) - 719468;
+}
+
+
+bool parse_time(std::string_view text, double& seconds) {
+  text = trim(text);
+  double value;
+  if (!text.empty() && scan_float(text, value) == text.size()) {
+    seconds = value;
+    return true;
+  }
+  int year;
+  int month;
+  int day;
+  if (!parse_digits(text, 0, 4, year) || text.size() < 10 || text[4] != '-' || !parse_digits(text, 5, 2, month)
+      || text[7] != '-' || !parse_digits(text, 8, 2, day) || month < 1 || month > 12 || day < 1 || day > 31) {
+    return false;
+  }
+  double time = 0.0;
+  size_t i = 10;
+  if (i < text.size()) {
+    int hour;
+    int minute;
+    if ((text[i] != 'T' && text[i] != ' ') || !parse_digits(text, i + 1, 2, hour)
+        || i + 3 >= text.size() || text[i + 3] != ':' || !parse_digits(text, i + 4, 2, minute)) {
+      return false;
+    }
+    i += 6;
+    double second = 0.0;
+    if (i < text.size() && text[i] == ':') {
+      const size_t length = i + 1 < text.size() && is_digit(text[i + 1]) ? scan_float(text.substr(i + 1), second) : 0;
+      if (length == 0) {
+        return false;
+      }
+      i += 1 + length;
+    }
+    time = 3600.0 * hour + 60.0 * minute + second;
+    if (i < text.size()) {
+      if (text[i] == 'Z') {
+        ++i;
+      }
+      else if (text[i] == '+' || text[i] == '-') {
+        const double sign = text[i] == '-' ? -1.0 : 1.0;
+        int offset_hours;
+        int offset_minutes = 0;
+        if (!parse_digits(text, i + 1, 2, offset_hours)) {
+          return false;
+        }
+        i += 3;
+        i += i < text.size() && text[i] == ':';
+        if (i < text.size()) {
+          if (!parse_digits(text, i, 2, offset_minutes)) {
+            return false;
+          }
+          i += 2;
+        }
+        time -= sign * (3600.0 * offset_hours + 60.0 * offset_minutes);
+      }
+      if (i != text.size()) {
+        return false;
+      }
+    }
+  }
+  seconds = 86400.0 * days_from_civil(year, month, day) + time;
+  return true;
+}
+
+
+void split_fields(const std::string_view line, const char delimiter, std::vector<std::string_view>& fields) {
+  fields.clear();
+  size_t begin = 0;
+  while (true) {
+    const size_t end = line.find(delimiter, begin);
+    std::string_view field = trim(line.substr(begin, end == std::string_view::npos ? end : end - begin));
+    if (field.size() >= 2 && field.front() == '"' && field.back() == '"') {
+      field = field.substr(1, field.size() - 2);
+    }
+    fields.push_back(field);
+    if (end == std::string_view::npos) {
+      return;
+    }
+    begin = end + 1;
+  }
+}
+
+
+bool nmea_checksum_valid(const std::string_view sentence) {
+  const size_t star = sentence.find('*');
+  if (star == std::string_view::npos) {
+    return true;
+  }
+  int checksum = 0;
+  for (size_t i = 1; i < star; ++i) {
+    checksum ^= static_cast<unsigned char>(sentence[i]);
+  }
+  const std::string_view hex = trim(sentence.substr(star + 1));
+  if (hex.size() != 2) {
+    return false;
+  }
+  int expected = 0;
+  for (const char c: hex) {
+    const int digit = is_digit(c) ? c - '0' : (c >= 'A' && c <= 'F') ? c - 'A' + 10 : (c >= 'a' && c <= 'f') ? c - 'a' + 10 : -1;
+    if (digit < 0) {
+      return false;
+    }
+    expected = 16 * expected + digit;
+  }
+  return checksum == expected;
+}
+
+}  // namespace geofun
@@ -0,0 +1,190 @@
+#include <geofun/polygon.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+#include <GeographicLib/PolygonArea.hpp>
+
+#include <fmt/format.h>
+
+namespace geofun {
+
+template <typename Area>
+std::pair<double, double> Polygon::measure(Area area) const {
+  for (size_t i = 0; i < latitudes_.size(); ++i) {
+    area.AddPoint(latitudes_[i], longitudes_[i]);
+  }
+  double perimeter;
+  double value;
+  area.Compute(false, true, perimeter, value);
+  return {perimeter, std::fabs(value)};
+}
+
+
+std::pair<double, double> Polygon::measure(const LineKind kind) const {
+  if (kind == LineKind::loxo) {
+    return measure(gl::PolygonAreaRhumb(ellipsoid_.rhumb()));
+  }
+  return measure(gl::PolygonArea(ellipsoid_.geodesic()));
+}
+
+
+Polygon::Bands Polygon::make_bands(const std::vector<std::pair<double, double>>& ranges,
+    const double min, const double max) {
+  // A few edges per band keeps the index small while most edges are skipped
+  const size_t bands = std::max<size_t>(1, std::min<size_t>(ranges.size() / 4, 4096));
+  Bands result{min, max > min ? bands / (max - min) : 0.0, std::vector<uint32_t>(bands + 1, 0), {}};
+  for (int pass = 0; pass < 2; ++pass) {
+    std::vector<uint32_t> fill(result.offsets.begin(), result.offsets.end() - 1);
+    for (size_t i = 0; i < ranges.size(); ++i) {
+      const size_t first = result.get(ranges[i].first);
+      const size_t last = result.get(ranges[i].second);
+      for (size_t band = first; band <= last; ++band) {
+        if (pass == 0) {
+          ++result.offsets[band + 1];
+        }
+        else {
+          result.edges[fill[band]++] = static_cast<uint32_t>(i);
+        }
+      }
+    }
+    if (pass == 0) {
+      std::partial_sum(result.offsets.begin(), result.offsets.end(), result.offsets.begin());
+      result.edges.resize(result.offsets.back());
+    }
+  }
+  return result;
+}
+
+
+void Polygon::prepare() {
+  const size_t size = latitudes_.size();
+  if (size < 3) {
+    throw std::invalid_argument(fmt::format("Polygon needs at least 3 vertices, got {}", size));
+  }
+  for (size_t i = 0; i < size; ++i) {
+    if (!(std::fabs(latitudes_[i]) <= 90.0) || !std::isfinite(longitudes_[i])) {
+      throw std::invalid_argument(fmt::format("Invalid vertex {}: {}, {}", i, latitudes_[i], longitudes_[i]));
+    }
+  }
+  std::vector<double> x(size);
+  std::vector<double> y(size);
+  std::vector<double> latitudes(latitudes_);
+  double latitude_sum = 0.0;
+  // Unwrap longitudes, so edges across the antimeridian stay short like loxodromes do
+  for (size_t i = 0; i < size; ++i) {
+    x[i] = i == 0 ? longitudes_[0] : x[i - 1] + angle_mod_signed(longitudes_[i] - longitudes_[i - 1]);
+    y[i] = isometric_latitude(latitudes_[i], eccentricity_);
+    latitude_sum += latitudes_[i];
+  }
+  const double winding = x[size - 1] + angle_mod_signed(longitudes_[0] - longitudes_[size - 1]) - x[0];
+  if (std::fabs(winding) > 180.0) {
+    // The ring goes around a pole: close it along the pole on the side of the vertices
+    const double pole_latitude = latitude_sum < 0.0 ? -90.0 : 90.0;
+    const double pole = isometric_latitude(pole_latitude, eccentricity_);
+    x.push_back(x[0] + winding);
+    y.push_back(y[0]);
+    latitudes.push_back(latitudes[0]);
+    x.push_back(x[0] + winding);
+    y.push_back(pole);
+    latitudes.push_back(pole_latitude);
+    x.push_back(x[0]);
+    y.push_back(pole);
+    latitudes.push_back(pole_latitude);
+  }
+  const size_t count = x.size();
+  const gl::Geodesic& geodesic = ellipsoid_.geodesic();
+  const double flattening = ellipsoid_.get_flattening();
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  edges_.resize(count);
+  geodesic_edges_.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    const size_t j = i + 1 < count ? i + 1 : 0;
+    edges_[i] = {x[i], y[i], x[j], y[j]};
+    const size_t west = x[i] <= x[j] ? i : j;
+    const size_t east = west == i ? j : i;
+    GeodesicEdge& edge = geodesic_edges_[i];
+    edge = {latitudes[west], x[west], nan,
+        std::min(latitudes[west], latitudes[east]), std::max(latitudes[west], latitudes[east])};
+    if (std::fabs(latitudes[west]) == 90.0 && latitudes[west] == latitudes[east]) {
+      continue;
+    }
+    double distance;
+    double azimuth2;
+    geodesic.Inverse(latitudes[west], x[west], latitudes[east], x[east], distance, edge.azimuth, azimuth2);
+    if ((edge.azimuth < 90.0) != (azimuth2 < 90.0)) {
+      // The edge passes the vertex of its geodesic, found from Clairaut's relation on reduced latitudes
+      const double reduced = std::atan((1.0 - flattening) * std::tan(d2r * latitudes[west]));
+      const double vertex = std::acos(std::fabs(std::sin(d2r * edge.azimuth)) * std::cos(reduced));
+      const double vertex_latitude = r2d * std::atan2(std::sin(vertex), (1.0 - flattening) * std::cos(vertex));
+      if (edge.azimuth < 90.0) {
+        edge.max_latitude = vertex_latitude;
+      }
+      else {
+        edge.min_latitude = -vertex_latitude;
+      }
+    }
+  }
+  min_x_ = *std::min_element(x.begin(), x.end());
+  max_x_ = *std::max_element(x.begin(), x.end());
+  min_y_ = *std::min_element(y.begin(), y.end());
+  max_y_ = *std::max_element(y.begin(), y.end());
+
+  std::vector<std::pair<double, double>> ranges(count);
+  for (size_t i = 0; i < count; ++i) {
+    ranges[i] = std::minmax(edges_[i].y1, edges_[i].y2);
+  }
+  latitude_bands_ = make_bands(ranges, min_y_, max_y_);
+  for (size_t i = 0; i < count; ++i) {
+    ranges[i] = std::minmax(edges_[i].x1, edges_[i].x2);
+  }
+  longitude_bands_ = make_bands(ranges, min_x_, max_x_);
+}
+
+
+bool Polygon::contains_ortho(const double latitude, const double longitude) const {
+  if (!(std::fabs(latitude) <= 90.0) || !std::isfinite(longitude)) {
+    return false;
+  }
+  const gl::Geodesic& geodesic = ellipsoid_.geodesic();
+  // Edge longitudes are unwrapped, so try each turn of longitude in their range
+  for (double x = min_x_ + angle_mod(longitude - min_x_); x <= max_x_; x += 360.0) {
+    const size_t band = longitude_bands_.get(x);
+    bool inside = false;
+    for (uint32_t i = longitude_bands_.offsets[band]; i < longitude_bands_.offsets[band + 1]; ++i) {
+      const uint32_t index = longitude_bands_.edges[i];
+      const Edge& edge = edges_[index];
+      if ((edge.x1 > x) == (edge.x2 > x)) {
+        continue;
+      }
+      const GeodesicEdge& geodesic_edge = geodesic_edges_[index];
+      bool north;
+      if (latitude < geodesic_edge.min_latitude) {
+        north = true;
+      }
+      else if (latitude > geodesic_edge.max_latitude) {
+        north = false;
+      }
+      else if (std::isnan(geodesic_edge.azimuth)) {
+        // Along a pole, which is inside
+        north = geodesic_edge.max_latitude > 0.0;
+      }
+      else {
+        double distance;
+        double azimuth;
+        double azimuth2;
+        geodesic.Inverse(geodesic_edge.latitude, geodesic_edge.longitude, latitude, x, distance, azimuth, azimuth2);
+        north = azimuth > geodesic_edge.azimuth;
+      }
+      inside = inside != north;
+    }
+    if (inside) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace geofun
@@ -0,0 +1,125 @@
+#include <geofun/primitives.hpp>
+
+#include <algorithm>
+
+#include <geofun/lines.hpp>
+#include <geofun/parse.hpp>
+
+namespace geofun {
+
+Point operator*(const double multiplier, const Point& point) {
+  return point.operator*(multiplier);
+}
+
+
+bool operator==(const Point& point, const Vector& vector) {
+  return vector.operator==(point);
+}
+
+Vector operator*(const double multiplier, const Vector& vector) {
+  return vector.operator*(multiplier);
+}
+
+Vector operator+(const double angle, const Vector& vector) {
+  return vector.operator+(angle);
+}
+
+Vector operator-(const double angle, const Vector& vector) {
+  return -vector.operator+(angle);
+}
+
+
+Point& Point::operator+=(const Vector& vector) {
+  x_ += vector.get_x();
+  y_ += vector.get_y();
+  return *this;
+}
+
+Point& Point::operator-=(const Vector& vector) {
+  x_ -= vector.get_x();
+  y_ -= vector.get_y();
+  return *this;
+}
+
+Point operator+(const Point& point, const Vector& vector) {
+  Point result{point};
+  result += vector;
+  return result;
+}
+
+Point operator-(const Point& point, const Vector& vector) {
+  Point result{point};
+  result -= vector;
+  return result;
+}
+
+
+Vector operator-(const Position& position2, const Position& position1) {
+  GEOFUN_PROBE(position_loxo);
+  const gl::Rhumb& rhumb = get_wgs84().rhumb();
+  double azimuth;
+  double distance;
+  rhumb.Inverse(
+      position1.get_latitude(),
+      position1.get_longitude(),
+      position2.get_latitude(),
+      position2.get_longitude(),
+      distance,
+      azimuth
+  );
+  return Vector(azimuth, distance);
+}
+
+
+Vector operator/(const Position& position2, const Position& position1) {
+  GEOFUN_PROBE(position_ortho);
+  const gl::Geodesic& geodesic = get_wgs84().geodesic();
+  double azimuth1;
+  double azimuth2;
+  double distance;
+  geodesic_inverse_kernel<output_distance | output_azimuth>(
+      geodesic,
+      position1.get_latitude(),
+      position1.get_longitude(),
+      position2.get_latitude(),
+      position2.get_longitude(),
+      distance,
+      azimuth1,
+      azimuth2
+  );
+  return Vector(azimuth1, distance);
+}
+
+
+std::vector<Position> Vector::split_ortho(
+    const Position& start, const int number_of_segments, const Ellipsoid* ellipsoid) const {
+  // Solve the geodesic once and evaluate positions along it
+  const gl::GeodesicLine line = ortho_line(*this, start, get_ellipsoid(ellipsoid));
+  std::vector<Position> result{};
+  result.reserve(std::max(number_of_segments, 0) + 1);
+  result.push_back(start);
+  for (int i = 1; i <= number_of_segments; ++i) {
+    double latitude;
+    double longitude;
+    line.Position(length_ * i / number_of_segments, latitude, longitude);
+    result.emplace_back(latitude, longitude);
+  }
+  return result;
+}
+
+std::vector<Position> Vector::split_loxo(
+    const Position& start, const int number_of_segments, const Ellipsoid* ellipsoid) const {
+  const gl::RhumbLine line = loxo_line(*this, start, get_ellipsoid(ellipsoid));
+  std::vector<Position> result{};
+  result.reserve(std::max(number_of_segments, 0) + 1);
+  result.push_back(start);
+  for (int i = 1; i <= number_of_segments; ++i) {
+    double latitude;
+    double longitude;
+    line.Position(length_ * i / number_of_segments, latitude, longitude);
+    result.emplace_back(latitude, longitude);
+  }
+  return result;
+}
+
+}  // namespace geofun
@@ -0,0 +1,105 @@
+#include <geofun/projection.hpp>
+
+#include <cmath>
+#include <stdexcept>
+
+#include <GeographicLib/Geocentric.hpp>
+
+#include <fmt/format.h>
+
+namespace geofun {
+
+ProjectionKind get_projection_kind(const std::string& name) {
+  if (name == "local") {
+    return ProjectionKind::local;
+  }
+  if (name == "transverse_mercator") {
+    return ProjectionKind::transverse_mercator;
+  }
+  if (name == "azimuthal_equidistant") {
+    return ProjectionKind::azimuthal_equidistant;
+  }
+  throw std::invalid_argument(fmt::format("Invalid projection kind: \"{}\"", name));
+}
+
+
+Projector::Projector(const Position& origin, const std::string& kind, const Ellipsoid& ellipsoid):
+    origin_(origin),
+    kind_(get_projection_kind(kind)),
+    local_(origin.get_latitude(), origin.get_longitude(), 0.0,
+        gl::Geocentric(ellipsoid.get_equatorial_radius(), ellipsoid.get_flattening())),
+    transverse_mercator_(ellipsoid.get_equatorial_radius(), ellipsoid.get_flattening(), 1.0),
+    azimuthal_equidistant_(ellipsoid.geodesic()) {
+  const gl::Geocentric geocentric(ellipsoid.get_equatorial_radius(), ellipsoid.get_flattening());
+  geocentric.Forward(origin.get_latitude(), origin.get_longitude(), 0.0,
+      center_[0], center_[1], center_[2], rotation_);
+  double easting;
+  transverse_mercator_.Forward(origin.get_longitude(), origin.get_latitude(), origin.get_longitude(),
+      easting, northing_);
+}
+
+
+void Projector::forward(const double latitude, const double longitude, double& x, double& y) const {
+  const double latitude0 = origin_.get_latitude();
+  const double longitude0 = origin_.get_longitude();
+  double height;
+  switch (kind_) {
+    case ProjectionKind::local:
+      local_.Forward(latitude, longitude, 0.0, y, x, height);
+      break;
+    case ProjectionKind::transverse_mercator:
+      transverse_mercator_.Forward(longitude0, latitude, longitude, y, x);
+      x -= northing_;
+      break;
+    case ProjectionKind::azimuthal_equidistant:
+      azimuthal_equidistant_.Forward(latitude0, longitude0, latitude, longitude, y, x);
+      break;
+  }
+}
+
+
+void Projector::reverse(const double x, const double y, double& latitude, double& longitude) const {
+  const double latitude0 = origin_.get_latitude();
+  const double longitude0 = origin_.get_longitude();
+  double height;
+  switch (kind_) {
+    case ProjectionKind::local:
+      local_.Reverse(y, x, get_local_height(x, y), latitude, longitude, height);
+      break;
+    case ProjectionKind::transverse_mercator:
+      transverse_mercator_.Reverse(longitude0, y, x + northing_, latitude, longitude);
+      break;
+    case ProjectionKind::azimuthal_equidistant:
+      azimuthal_equidistant_.Reverse(latitude0, longitude0, y, x, latitude, longitude);
+      break;
+  }
+}
+
+
+
+/**
+ * Get the height above the tangent plane point (x, y) of the ellipsoid along
+ * the up axis of the origin, which is how forward projects. That is the
+ * nearest root of the quadratic for the line from the point through the
+ * ellipsoid, with coordinates scaled to make it a unit sphere. NaN beyond
+ * the horizon.
+ */
+double Projector::get_local_height(const double x, const double y) const {
+  const double equatorial_radius = local_.EquatorialRadius();
+  const double scales[] = {
+      equatorial_radius, equatorial_radius, equatorial_radius * (1.0 - local_.Flattening())};
+  double a = 0.0;
+  double b = 0.0;
+  double c = -1.0;
+  for (int i = 0; i < 3; ++i) {
+    // Columns of the rotation are the east, north and up axes
+    const double point = (center_[i] + rotation_[3 * i] * y + rotation_[3 * i + 1] * x) / scales[i];
+    const double up = rotation_[3 * i + 2] / scales[i];
+    a += up * up;
+    b += 2.0 * point * up;
+    c += point * point;
+  }
+  return -2.0 * c / (b + std::sqrt(b * b - 4.0 * a * c));
+}
+
+}  // namespace geofun
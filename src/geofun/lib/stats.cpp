@@ -0,0 +1,159 @@
+#include <geofun/stats.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <iterator>
+#include <mutex>
+
+namespace geofun {
+
+static constexpr size_t probe_count = static_cast<size_t>(Probe::count);
+
+static const char* const probe_names[] = {
+  "rhumb_direct",
+  "rhumb_inverse",
+  "geodesic_direct",
+  "geodesic_inverse",
+  "Position + Vector",
+  "Position - Vector",
+  "Position * Vector",
+  "Position / Vector",
+  "Position - Position",
+  "Position / Position",
+  "PositionArray + VectorArray",
+  "PositionArray - VectorArray",
+  "PositionArray * VectorArray",
+  "PositionArray / VectorArray",
+  "PositionArray - PositionArray",
+  "PositionArray / PositionArray",
+  "rhumb_direct_batch",
+  "rhumb_inverse_batch",
+  "geodesic_direct_batch",
+  "geodesic_inverse_batch",
+  "rhumb_distance_batch",
+  "rhumb_azimuth_batch",
+  "geodesic_distance_batch",
+  "geodesic_azimuth_batch",
+  "distance_matrix",
+  "track_metrics",
+};
+static_assert(std::size(probe_names) == probe_count, "Every probe needs a name");
+
+
+/**
+ * Counters of a probe. They are only written by the thread that owns the
+ * slot, so the atomics are uncontended and only keep reads and resets from
+ * other threads well defined.
+ */
+struct Counters {
+  std::atomic<uint64_t> calls{0};
+  std::atomic<uint64_t> items{0};
+  std::atomic<uint64_t> nanoseconds{0};
+};
+
+using Slot = std::array<Counters, probe_count>;
+
+
+/**
+ * Slots of the running threads, plus the totals of threads that finished
+ */
+struct Registry {
+  std::mutex mutex;
+  std::vector<Slot*> slots;
+  Slot finished;
+};
+
+
+static Registry& get_registry() {
+  // Never destroyed, as threads may finish after static destruction
+  static Registry* registry = new Registry();
+  return *registry;
+}
+
+
+static void add_counters(Counters& total, const Counters& counters) {
+  total.calls += counters.calls.load(std::memory_order_relaxed);
+  total.items += counters.items.load(std::memory_order_relaxed);
+  total.nanoseconds += counters.nanoseconds.load(std::memory_order_relaxed);
+}
+
+
+static void clear_counters(Counters& counters) {
+  counters.calls.store(0, std::memory_order_relaxed);
+  counters.items.store(0, std::memory_order_relaxed);
+  counters.nanoseconds.store(0, std::memory_order_relaxed);
+}
+
+
+/**
+ * Slot of a thread, registered while the thread runs
+ */
+class ThreadSlot {
+public:
+  ThreadSlot() {
+    Registry& registry = get_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.slots.push_back(&slot_);
+  }
+
+  ~ThreadSlot() {
+    Registry& registry = get_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (size_t i = 0; i < probe_count; ++i) {
+      add_counters(registry.finished[i], slot_[i]);
+    }
+    registry.slots.erase(std::find(registry.slots.begin(), registry.slots.end(), &slot_));
+  }
+
+  Slot& get() {
+    return slot_;
+  }
+
+private:
+  Slot slot_;
+};
+
+
+std::vector<ProbeStats> get_stats() {
+  std::vector<ProbeStats> result;
+  if (!stats_enabled) {
+    return result;
+  }
+  Registry& registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (size_t i = 0; i < probe_count; ++i) {
+    Counters total;
+    add_counters(total, registry.finished[i]);
+    for (const Slot* slot: registry.slots) {
+      add_counters(total, (*slot)[i]);
+    }
+    if (total.calls > 0) {
+      result.push_back({probe_names[i], total.calls, total.items, 1e-9 * total.nanoseconds});
+    }
+  }
+  return result;
+}
+
+
+void reset_stats() {
+  Registry& registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (size_t i = 0; i < probe_count; ++i) {
+    clear_counters(registry.finished[i]);
+    for (Slot* slot: registry.slots) {
+      clear_counters((*slot)[i]);
+    }
+  }
+}
+
+
+void record_probe(const Probe probe, const uint64_t items, const uint64_t nanoseconds) {
+  thread_local ThreadSlot slot;
+  Counters& counters = slot.get()[static_cast<size_t>(probe)];
+  counters.calls.fetch_add(1, std::memory_order_relaxed);
+  counters.items.fetch_add(items, std::memory_order_relaxed);
+  counters.nanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+}
+
+}  // namespace geofun
@@ -0,0 +1,300 @@
+#include <geofun/tracks.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include <geofun/angles.hpp>
+#include <geofun/parallel.hpp>
+#include <geofun/parse.hpp>
+#include <geofun/stats.hpp>
+
+namespace geofun {
+
+TrackReader::TrackReader(const std::string& path, const std::string& format, const std::ptrdiff_t chunk_size,
+    const std::optional<std::string>& time_column, const std::string& latitude_column, const std::string& longitude_column,
+    const char delimiter, const bool legs, const std::string& metric, const Ellipsoid* ellipsoid):
+    file_(std::fopen(path.c_str(), "rb"), &std::fclose),
+    buffer_(1 << 20),
+    chunk_size_(chunk_size),
+    delimiter_(delimiter),
+    legs_(legs),
+    ellipsoid_(get_ellipsoid(ellipsoid)) {
+  if (format == "csv") {
+    format_ = TrackFormat::csv;
+  }
+  else if (format == "nmea") {
+    format_ = TrackFormat::nmea;
+  }
+  else {
+    throw std::invalid_argument(fmt::format("Invalid track format: \"{}\"", format));
+  }
+  metric_ = get_leg_metric(metric);
+  if (chunk_size_ < 1) {
+    throw std::invalid_argument(fmt::format("Invalid chunk size: {}", chunk_size_));
+  }
+  if (!file_) {
+    throw std::runtime_error(fmt::format("Failed to open track file: \"{}\"", path));
+  }
+  times_.resize(chunk_size_);
+  latitudes_.resize(chunk_size_);
+  longitudes_.resize(chunk_size_);
+  if (legs_) {
+    distances_.resize(chunk_size_);
+    azimuths_.resize(chunk_size_);
+  }
+  if (format_ == TrackFormat::csv) {
+    std::string_view header;
+    if (!next_line(header)) {
+      throw std::invalid_argument(fmt::format("Track file \"{}\" has no header", path));
+    }
+    split_fields(header, delimiter_, fields_);
+    auto column = [&](const std::string& name) {
+      const auto found = std::find(fields_.begin(), fields_.end(), name);
+      if (found == fields_.end()) {
+        throw std::invalid_argument(fmt::format("Column \"{}\" not found in track file \"{}\"", name, path));
+      }
+      return static_cast<size_t>(found - fields_.begin());
+    };
+    time_index_ = time_column ? column(*time_column) : no_column;
+    latitude_index_ = column(latitude_column);
+    longitude_index_ = column(longitude_column);
+  }
+}
+
+
+bool TrackReader::next_line(std::string_view& line) {
+  while (true) {
+    const char* begin = buffer_.data() + begin_;
+    const char* newline = static_cast<const char*>(std::memchr(begin, '\n', end_ - begin_));
+    if (newline != nullptr || (eof_ && begin_ < end_)) {
+      const size_t end = newline != nullptr ? newline - buffer_.data() : end_;
+      line = std::string_view(begin, end - begin_);
+      if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+      }
+      begin_ = std::min(end + 1, end_);
+      return true;
+    }
+    if (eof_) {
+      return false;
+    }
+    // Keep the partial line, growing the buffer only for lines that don't fit
+    std::memmove(buffer_.data(), begin, end_ - begin_);
+    end_ -= begin_;
+    begin_ = 0;
+    if (end_ == buffer_.size()) {
+      buffer_.resize(2 * buffer_.size());
+    }
+    const size_t read = std::fread(buffer_.data() + end_, 1, buffer_.size() - end_, file_.get());
+    if (read == 0) {
+      if (std::ferror(file_.get())) {
+        throw std::runtime_error("Failed to read track file");
+      }
+      eof_ = true;
+    }
+    end_ += read;
+  }
+}
+
+
+std::ptrdiff_t TrackReader::fill() {
+  std::ptrdiff_t count = 0;
+  std::string_view line;
+  while (count < chunk_size_ && next_line(line)) {
+    const Record record = format_ == TrackFormat::csv
+        ? parse_csv(line, times_[count], latitudes_[count], longitudes_[count])
+        : parse_nmea(line, times_[count], latitudes_[count], longitudes_[count]);
+    count += record == Record::valid;
+    skipped_ += record == Record::invalid;
+  }
+  return count;
+}
+
+
+TrackReader::Record TrackReader::parse_csv(const std::string_view line, double& time, double& latitude, double& longitude) {
+  if (trim(line).empty()) {
+    return Record::ignored;
+  }
+  split_fields(line, delimiter_, fields_);
+  const size_t last = std::max({latitude_index_, longitude_index_, time_index_ == no_column ? 0 : time_index_});
+  if (fields_.size() <= last
+      || scan_float(fields_[latitude_index_], latitude) != fields_[latitude_index_].size()
+      || scan_float(fields_[longitude_index_], longitude) != fields_[longitude_index_].size()
+      || fields_[latitude_index_].empty() || fields_[longitude_index_].empty()
+      || std::fabs(latitude) > 90.0) {
+    return Record::invalid;
+  }
+  longitude = angle_mod_signed(longitude);
+  time = std::numeric_limits<double>::quiet_NaN();
+  if (time_index_ != no_column && !parse_time(fields_[time_index_], time)) {
+    return Record::invalid;
+  }
+  return Record::valid;
+}
+
+
+TrackReader::Record TrackReader::parse_nmea(const std::string_view line, double& time, double& latitude, double& longitude) {
+  const std::string_view sentence = trim(line);
+  if (sentence.size() < 6 || sentence[0] != '$') {
+    return Record::ignored;
+  }
+  const std::string_view type = sentence.substr(3, 3);
+  const bool rmc = type == "RMC";
+  if (!rmc && type != "GGA") {
+    return Record::ignored;
+  }
+  if (!nmea_checksum_valid(sentence)) {
+    return Record::invalid;
+  }
+  split_fields(sentence.substr(0, sentence.find('*')), ',', fields_);
+  const size_t offset = rmc ? 3 : 2;
+  if (fields_.size() < (rmc ? 10 : 7)) {
+    return Record::invalid;
+  }
+  if ((rmc && fields_[2] != "A") || (!rmc && (fields_[6].empty() || fields_[6] == "0"))) {
+    // No fix
+    return Record::ignored;
+  }
+  double time_of_day;
+  if (scan_float(fields_[1], time_of_day) != fields_[1].size() || fields_[1].empty()
+      || !parse_nmea_angle(fields_[offset], fields_[offset + 1], 'N', 'S', 90.0, latitude)
+      || !parse_nmea_angle(fields_[offset + 2], fields_[offset + 3], 'E', 'W', 180.0, longitude)) {
+    return Record::invalid;
+  }
+  const double hours = std::floor(time_of_day / 10000.0);
+  const double minutes = std::floor(time_of_day / 100.0) - 100.0 * hours;
+  time_of_day = 3600.0 * hours + 60.0 * minutes + (time_of_day - 10000.0 * hours - 100.0 * minutes);
+  if (time_of_day < last_time_of_day_ - 43200.0) {
+    // Past midnight since the last record
+    day_ += 86400.0;
+  }
+  if (rmc) {
+    int day;
+    int month;
+    int year;
+    if (fields_[9].size() != 6 || !parse_digits(fields_[9], 0, 2, day) || !parse_digits(fields_[9], 2, 2, month)
+        || !parse_digits(fields_[9], 4, 2, year)) {
+      return Record::invalid;
+    }
+    day_ = 86400.0 * days_from_civil(year < 80 ? 2000 + year : 1900 + year, month, day);
+  }
+  else if (std::isnan(day_)) {
+    // No date yet
+    return Record::ignored;
+  }
+  last_time_of_day_ = time_of_day;
+  time = day_ + time_of_day;
+  if (time == last_time_) {
+    return Record::ignored;
+  }
+  last_time_ = time;
+  return Record::valid;
+}
+
+
+void TrackReader::compute_legs(const std::ptrdiff_t count) {
+  double* distance = distances_.data();
+  double* azimuth = azimuths_.data();
+  const gl::Geodesic& geodesic = ellipsoid_.geodesic();
+  const gl::Rhumb& rhumb = ellipsoid_.rhumb();
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  parallel_for(count, 0, [&](const std::ptrdiff_t begin, const std::ptrdiff_t end) {
+    for (std::ptrdiff_t i = begin; i < end; ++i) {
+      const double latitude1 = i > 0 ? latitudes_[i - 1] : last_latitude_;
+      const double longitude1 = i > 0 ? longitudes_[i - 1] : last_longitude_;
+      if (std::isnan(latitude1)) {
+        distance[i] = nan;
+        azimuth[i] = nan;
+        continue;
+      }
+      if (metric_ == Metric::rhumb) {
+        rhumb.Inverse(latitude1, longitude1, latitudes_[i], longitudes_[i], distance[i], azimuth[i]);
+      }
+      else {
+        double azimuth2;
+        geodesic.Inverse(latitude1, longitude1, latitudes_[i], longitudes_[i], distance[i], azimuth[i], azimuth2);
+      }
+      azimuth[i] = angle_mod(azimuth[i]);
+    }
+  });
+  last_latitude_ = latitudes_[count - 1];
+  last_longitude_ = longitudes_[count - 1];
+}
+
+
+void compute_track_metrics(const double* time, const double* latitude, const double* longitude,
+    const std::ptrdiff_t size, const int64_t* id, const Metric metric, const int threads, const Ellipsoid& ellipsoid,
+    const TrackMetrics& metrics) {
+  GEOFUN_PROBE(track_metrics, size);
+  auto starts_track = [&](const std::ptrdiff_t i) {
+    return i == 0 || (id != nullptr && id[i] != id[i - 1]);
+  };
+  double* distance = metrics.distances;
+  double* azimuth = metrics.azimuths;
+  double* final_azimuth = metrics.final_azimuths;
+  double* speed = metrics.speeds;
+  double* course = metrics.courses;
+  double* cumulative_distance = metrics.cumulative_distances;
+  double* turn_rate = metrics.turn_rates;
+  const gl::Geodesic& geodesic = ellipsoid.geodesic();
+  const gl::Rhumb& rhumb = ellipsoid.rhumb();
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  // Legs ending at each record
+  parallel_for(size, threads, [&](const std::ptrdiff_t begin, const std::ptrdiff_t end) {
+    for (std::ptrdiff_t i = begin; i < end; ++i) {
+      if (starts_track(i)) {
+        distance[i] = azimuth[i] = final_azimuth[i] = speed[i] = nan;
+        continue;
+      }
+      if (metric == Metric::rhumb) {
+        rhumb.Inverse(latitude[i - 1], longitude[i - 1], latitude[i], longitude[i], distance[i], azimuth[i]);
+        final_azimuth[i] = azimuth[i];
+      }
+      else {
+        geodesic.Inverse(latitude[i - 1], longitude[i - 1], latitude[i], longitude[i],
+            distance[i], azimuth[i], final_azimuth[i]);
+      }
+      azimuth[i] = angle_mod(azimuth[i]);
+      final_azimuth[i] = angle_mod(final_azimuth[i]);
+      const double duration = time[i] - time[i - 1];
+      speed[i] = duration > 0.0 ? distance[i] / duration : nan;
+    }
+  });
+  // Course over ground is the final azimuth of the leg arriving at a record,
+  // or the azimuth of the leg leaving the first record of a track. Legs
+  // between coincident fixes have an arbitrary azimuth, so they carry the
+  // course over. Turn rates start at the second leg that moved, since the
+  // course along a single leg only turns by meridian convergence.
+  auto moved = [&](const std::ptrdiff_t i) {
+    return distance[i] >= stationary_distance;
+  };
+  double total = 0.0;
+  int moved_legs = 0;
+  for (std::ptrdiff_t i = 0; i < size; ++i) {
+    if (starts_track(i)) {
+      total = 0.0;
+      moved_legs = 0;
+      course[i] = i + 1 < size && !starts_track(i + 1) && moved(i + 1) ? azimuth[i + 1] : nan;
+      turn_rate[i] = nan;
+    }
+    else {
+      total += distance[i];
+      if (moved(i)) {
+        course[i] = final_azimuth[i];
+        ++moved_legs;
+      }
+      else {
+        course[i] = course[i - 1];
+      }
+      const double duration = time[i] - time[i - 1];
+      turn_rate[i] = moved_legs >= 2 && duration > 0.0 ? angle_diff(course[i], course[i - 1]) / duration : nan;
+    }
+    cumulative_distance[i] = total;
+  }
+}
+
+}  // namespace geofun
@@ -28,6 +28,24 @@ def test(ctx):
         ctx.run(cmd, echo=True)
 
 
+@task
+def benchmark(ctx, native=False):
+    """Run benchmarks, writing JSON results next to the test reports"""
+    cmds = [
+        "pytest benchmarks --benchmark-json=../build/reports/benchmarks.json",
+    ]
+    if native:
+        cmds += [
+            "cmake -S . -B build/native -DCMAKE_BUILD_TYPE=Release "
+            "-DCMAKE_PREFIX_PATH=contrib/install -DGEOFUN_BUILD_BENCHMARKS=ON",
+            "cmake --build build/native --target geofun_benchmarks",
+            "build/native/geofun_benchmarks --benchmark_out_format=json "
+            "--benchmark_out=../build/reports/native_benchmarks.json",
+        ]
+    for cmd in cmds:
+        ctx.run(cmd, echo=True)
+
+
 @task
 def build_doc(ctx):
     for cmd in (
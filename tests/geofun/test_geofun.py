@@ -7,9 +7,22 @@ from copy import copy
 import numpy as np
 import pytest
 
-from geofun import (Point, Position, Vector, angle_mod, angle_mod_signed,
-                    geodesic_direct, geodesic_inverse, get_version,
-                    rhumb_direct, rhumb_inverse)
+from geofun import (Ellipsoid, Point, Polygon, Position, PositionArray,
+                    PositionIndex, Projector, TrackReader, Vector, VectorArray,
+                    andoyer_lambert_distance, angle_diff, angle_mod,
+                    angle_mod_signed, cpa, cpa_batch, cross_track,
+                    cross_track_batch, distance_matrix,
+                    equirectangular_distance, geodesic_azimuth_batch,
+                    geodesic_direct, geodesic_direct_batch,
+                    geodesic_distance_batch, geodesic_inverse,
+                    geodesic_inverse_batch, geodesic_within, geohash_decode,
+                    geohash_encode, get_threads, get_version,
+                    haversine_distance, intersection, mgrs_decode, mgrs_encode,
+                    normalize_positions, parse_positions, reset_stats,
+                    rhumb_azimuth_batch, rhumb_direct, rhumb_direct_batch,
+                    rhumb_distance_batch, rhumb_inverse, rhumb_inverse_batch,
+                    route_intersections, set_threads, simplify, stats,
+                    stats_enabled, track_metrics, utm_decode, utm_encode)
 
 
 def test_version():
@@ -27,6 +40,40 @@ def test_angle_mod():
     assert angle_mod_signed(-90) == -90
 
 
+def test_angle_arrays():
+    angles = np.array([0, -0.0, 720, 630, -90, 180, -180, 359.9, 1e300, np.nan])
+    expected = np.fmod(angles, 360)
+    expected = np.where(expected < 0, expected + 360, expected)
+    np.testing.assert_array_equal(angle_mod(angles), expected)
+    signed = np.where(expected >= 180, expected - 360, expected)
+    np.testing.assert_array_equal(angle_mod_signed(angles), signed)
+    np.testing.assert_array_equal(angle_diff(angles, 90), angle_mod_signed(angles - 90))
+    assert angle_diff(10, 350) == 20
+    assert angle_mod([720, -90]).tolist() == [0.0, 270.0]
+    # Output is checked before anything is written to it
+    strided = np.zeros(20)[::2]
+    with pytest.raises(ValueError):
+        angle_diff(angles, 90, out=strided)
+    assert not strided.any()
+
+    # Float32 stays float32, out works in place
+    single = angle_mod(np.arange(-1000, 1000, 0.5, dtype=np.float32))
+    assert single.dtype == np.float32
+    assert single == pytest.approx(angle_mod(np.arange(-1000, 1000, 0.5)))
+    angles = np.linspace(-1000, 1000, 10001)
+    expected = angle_mod_signed(angles)
+    assert angle_mod_signed(angles, out=angles, threads=2) is angles
+    np.testing.assert_array_equal(angles, expected)
+    with pytest.raises(ValueError):
+        angle_mod(angles, out=np.empty(10001, dtype=int))
+
+    latitudes, longitudes = normalize_positions([100, -95, 45], [190, 0, -540])
+    position = Position(100.0, 190.0)
+    assert (latitudes[0], longitudes[0]) == (position.latitude, position.longitude)
+    np.testing.assert_array_equal(latitudes, [80, -85, 45])
+    np.testing.assert_array_equal(longitudes, [-170, 0, -180])
+
+
 def test_rhumb_direct(log):
     lat, lon, azi = rhumb_direct(52.0, 4.0, 45.0, 10000)
     log.debug(f"lat: {lat}, lon: {lon}, azi: {azi}")
@@ -59,6 +106,595 @@ def test_geodesic_inverse(log):
     assert dist == pytest.approx(10000, abs=1e-4)
 
 
+def test_geodesic_direct_batch(log):
+    lats = np.array([52.0, 52.0, -10.0])
+    lons = np.array([4.0, 4.0, 170.0])
+    azis = np.array([45.0, 45.0, 300.0])
+    dists = np.array([10000.0, 0.0, 2e6])
+    result = geodesic_direct_batch(lats, lons, azis, dists)
+    log.debug(f"result: {result}")
+    assert result.shape == (3, 3)
+    for row, args in zip(result, zip(lats, lons, azis, dists)):
+        assert row == pytest.approx(geodesic_direct(*args), abs=1e-12)
+    out = np.empty((3, 3))
+    assert geodesic_direct_batch(lats, lons, azis, dists, out=out) is out
+    assert (out == result).all()
+    with pytest.raises(ValueError):
+        geodesic_direct_batch(lats, lons, azis, dists[:2])
+    with pytest.raises(ValueError):
+        geodesic_direct_batch(lats, lons, azis, dists, out=np.empty((3, 2)))
+    with pytest.raises(ValueError):
+        geodesic_direct_batch(lats, lons, azis, dists, out=np.empty((3, 3), dtype=np.float32))
+
+
+def test_geodesic_inverse_batch(log):
+    lats1 = np.array([52.0, 52.0, -10.0])
+    lons1 = np.array([4.0, 28.0, 170.0])
+    lats2 = np.array([52.0635048312, 4.0, 10.0])
+    lons2 = np.array([4.10310567353, -16.6, -170.0])
+    result = geodesic_inverse_batch(lats1, lons1, lats2, lons2)
+    log.debug(f"result: {result}")
+    assert result.shape == (3, 3)
+    for row, args in zip(result, zip(lats1, lons1, lats2, lons2)):
+        assert row == pytest.approx(geodesic_inverse(*args), abs=1e-12)
+    assert result[0, 1] == pytest.approx(10000, abs=1e-4)
+
+
+def test_rhumb_direct_batch(log):
+    # One origin, several azimuths and distances
+    azis = np.array([0.0, 45.0, 270.0])
+    dists = np.array([[1000.0], [10000.0]])
+    result = rhumb_direct_batch(52.0, 4.0, azis, dists)
+    log.debug(f"result: {result}")
+    assert result.shape == (2, 3, 3)
+    for i in range(2):
+        for j in range(3):
+            expected = rhumb_direct(52.0, 4.0, azis[j], dists[i, 0])
+            assert result[i, j] == pytest.approx(expected, abs=1e-12)
+    out = np.zeros((2, 3, 3))
+    rhumb_direct_batch(52.0, 4.0, azis, dists, out=out)
+    assert (out == result).all()
+    with pytest.raises(ValueError):
+        rhumb_direct_batch(52.0, 4.0, azis, np.ones(2))
+
+
+def test_rhumb_inverse_batch(log):
+    # Several origins against several targets
+    lats1 = np.array([52.0, 51.0])
+    lats2 = np.array([52.0635499025, 50.0])
+    lons2 = np.array([4.10303268597, 3.0])
+    result = rhumb_inverse_batch(lats1, 4.0, lats2, lons2)
+    log.debug(f"result: {result}")
+    assert result.shape == (2, 3)
+    for row, args in zip(result, zip(lats1, lats2, lons2)):
+        expected = rhumb_inverse(args[0], 4.0, args[1], args[2])
+        assert row == pytest.approx(expected, abs=1e-12)
+    assert result[0, 1] == pytest.approx(10000, abs=1e-4)
+
+
+def test_inverse_outputs():
+    lats1 = np.array([52.0, 52.0, -10.0])
+    lons1 = np.array([4.0, 28.0, 170.0])
+    lats2 = np.array([52.0635048312, 4.0, 10.0])
+    lons2 = np.array([4.10310567353, -16.6, -170.0])
+    full = geodesic_inverse_batch(lats1, lons1, lats2, lons2)
+    distances = geodesic_distance_batch(lats1, lons1, lats2, lons2)
+    assert distances.shape == (3,)
+    assert distances == pytest.approx(full[:, 1], abs=1e-9)
+    azimuths = geodesic_azimuth_batch(lats1, lons1, lats2, lons2)
+    assert azimuths == pytest.approx(full[:, 0], abs=1e-12)
+    full = rhumb_inverse_batch(lats1, lons1, lats2, lons2)
+    out = np.empty(3)
+    assert rhumb_distance_batch(lats1, lons1, lats2, lons2, out=out) is out
+    assert out == pytest.approx(full[:, 1], abs=1e-9)
+    azimuths = rhumb_azimuth_batch(lats1, lons1, lats2, lons2)
+    assert azimuths == pytest.approx(full[:, 0], abs=1e-12)
+
+
+def test_threaded_batch(log):
+    rng = np.random.default_rng(1)
+    lats1 = rng.uniform(-80, 80, 20000)
+    lons1 = rng.uniform(-180, 180, 20000)
+    lats2 = rng.uniform(-80, 80, 20000)
+    lons2 = rng.uniform(-180, 180, 20000)
+    single = geodesic_inverse_batch(lats1, lons1, lats2, lons2, threads=1)
+    multi = geodesic_inverse_batch(lats1, lons1, lats2, lons2, threads=4)
+    assert (single == multi).all()
+    single = rhumb_inverse_batch(lats1, lons1, lats2, lons2, threads=1)
+    multi = rhumb_inverse_batch(lats1, lons1, lats2, lons2, threads=4)
+    assert (single == multi).all()
+    threads = get_threads()
+    assert threads >= 1
+    set_threads(2)
+    assert get_threads() == 2
+    set_threads(0)
+    assert get_threads() == threads
+    with pytest.raises(ValueError):
+        set_threads(-1)
+
+
+def test_stats():
+    reset_stats()
+    geodesic_inverse(52, 4, 28, -16.6)
+    Position(52, 4) * Vector(225, 1000)
+    geodesic_inverse_batch([52, 53, 54], 4, 28, -16.6)
+    result = stats()
+    if not stats_enabled:
+        assert result == {}
+        return
+    assert result["geodesic_inverse"]["calls"] == 1
+    assert result["Position * Vector"]["calls"] == 1
+    assert result["geodesic_inverse_batch"]["calls"] == 1
+    assert result["geodesic_inverse_batch"]["items"] == 3
+    assert result["geodesic_inverse"]["time"] > 0
+    reset_stats()
+    assert stats() == {}
+
+
+def test_ellipsoid():
+    wgs84 = Ellipsoid(6378137.0, 1 / 298.257223563)
+    assert wgs84 == Ellipsoid.wgs84()
+    assert geodesic_inverse(52, 4, 28, -16.6, ellipsoid=wgs84) == pytest.approx(
+        geodesic_inverse(52, 4, 28, -16.6)
+    )
+    sphere = Ellipsoid(6371000.0, 0.0)
+    assert sphere.equatorial_radius == 6371000.0
+    assert sphere.flattening == 0.0
+    azi1, dist, azi2 = geodesic_inverse(0, 0, 0, 90, ellipsoid=sphere)
+    assert dist == pytest.approx(6371000.0 * np.pi / 2, abs=1e-6)
+    lat, lon, azi = rhumb_direct(0, 0, 0, 6371000.0 * np.pi / 4, sphere)
+    assert lat == pytest.approx(45.0, abs=1e-9)
+    lat, lon, azi = geodesic_direct(0, 0, 90, 1000000, ellipsoid=sphere)
+    assert lon == pytest.approx(np.degrees(1000000 / 6371000.0), abs=1e-9)
+
+    result = geodesic_inverse_batch([0, 10], 0, 0, 90, ellipsoid=sphere)
+    assert result[0, 1] == pytest.approx(dist)
+    result = rhumb_inverse_batch(0, 0, 45, 0, ellipsoid=sphere)
+    assert result[1] == pytest.approx(6371000.0 * np.pi / 4)
+    assert distance_matrix([[0, 0], [0, 90]], ellipsoid=sphere)[0, 1] == pytest.approx(dist)
+
+    v = Vector(90, 1000000)
+    p = Position(0, 0)
+    assert v.split_ortho(p, 2, sphere)[-1] != v.split_ortho(p, 2)[-1]
+    assert v.split_ortho_array(p, 2, ellipsoid=sphere)[-1, 1] == pytest.approx(np.degrees(1000000 / 6371000.0))
+    assert v.split_loxo(p, 2, ellipsoid=sphere)[-1].longitude == pytest.approx(np.degrees(1000000 / 6371000.0))
+
+    assert pickle.loads(pickle.dumps(sphere)) == sphere
+    assert repr(sphere).startswith("Ellipsoid(6371000")
+
+
+def test_approximate_distances():
+    rng = np.random.default_rng(4)
+    lat1 = rng.uniform(-80, 80, 1000)
+    lon1 = rng.uniform(-180, 180, 1000)
+    lat2 = rng.uniform(-80, 80, 1000)
+    lon2 = rng.uniform(-180, 180, 1000)
+    exact = geodesic_inverse_batch(lat1, lon1, lat2, lon2)[:, 1]
+    assert haversine_distance(lat1, lon1, lat2, lon2) == pytest.approx(exact, rel=6e-3)
+    assert andoyer_lambert_distance(lat1, lon1, lat2, lon2) == pytest.approx(exact, rel=1e-4)
+
+    azimuths = rng.uniform(0, 360, 1000)
+    distances = rng.uniform(1, 100000, 1000)
+    ends = geodesic_direct_batch(lat1, lon1, azimuths, distances)
+    approximations = equirectangular_distance(lat1, lon1, ends[:, 0], ends[:, 1])
+    assert approximations.shape == (1000,)
+    assert approximations == pytest.approx(distances, rel=1e-3)
+    out = np.empty(1000)
+    andoyer_lambert_distance(lat1, lon1, ends[:, 0], ends[:, 1], out=out, threads=2)
+    assert out == pytest.approx(distances, rel=1e-4)
+
+    radius = 50000.0
+    within = geodesic_within(lat1, lon1, ends[:, 0], ends[:, 1], radius)
+    assert within.dtype == bool
+    assert (within == (distances <= radius)).all()
+    assert geodesic_within(52, 4, 52, 5, [68000, 69000]).tolist() == [False, True]
+
+
+def test_distance_matrix(log):
+    rng = np.random.default_rng(2)
+    a = np.column_stack((rng.uniform(-80, 80, 70), rng.uniform(-180, 180, 70)))
+    b = np.column_stack((rng.uniform(-80, 80, 90), rng.uniform(-180, 180, 90)))
+    result = distance_matrix(a, b)
+    assert result.shape == (70, 90)
+    for i, j in ((0, 0), (3, 89), (69, 65)):
+        expected = geodesic_inverse(a[i, 0], a[i, 1], b[j, 0], b[j, 1])[1]
+        assert result[i, j] == pytest.approx(expected, abs=1e-6)
+    rhumbs = distance_matrix(PositionArray(a), b, metric="rhumb")
+    for i, j in ((0, 0), (3, 89), (69, 65)):
+        expected = rhumb_inverse(a[i, 0], a[i, 1], b[j, 0], b[j, 1])[1]
+        assert rhumbs[i, j] == pytest.approx(expected, abs=1e-6)
+    haversines = distance_matrix(a, b, metric="haversine")
+    assert haversines == pytest.approx(result, rel=6e-3)
+
+    symmetric = distance_matrix(b, threads=2)
+    assert (symmetric == symmetric.T).all()
+    assert (np.diag(symmetric) == 0).all()
+    full = distance_matrix(b, b)
+    assert symmetric == pytest.approx(full, abs=1e-6)
+    out = np.empty((90, 90))
+    distance_matrix(b, metric="haversine", out=out)
+    assert out == pytest.approx(distance_matrix(b, b, metric="haversine"), abs=1e-6)
+    with pytest.raises(ValueError):
+        distance_matrix(a, b, metric="manhattan")
+
+
+def test_position_index():
+    rng = np.random.default_rng(3)
+    points = np.column_stack((rng.uniform(-89, 89, 2000), rng.uniform(-180, 180, 2000)))
+    queries = np.column_stack((rng.uniform(-89, 89, 50), rng.uniform(-180, 180, 50)))
+    index = PositionIndex(points)
+    assert len(index) == 2000
+    distances = distance_matrix(queries, points)
+    order = np.argsort(distances, axis=1)
+
+    indices, nearest = index.nearest(queries, count=5, threads=2)
+    assert indices.shape == (50, 5)
+    assert (indices == order[:, :5]).all()
+    assert nearest == pytest.approx(np.take_along_axis(distances, order[:, :5], axis=1), abs=1e-6)
+
+    radius = 500000.0
+    offsets, found, found_distances = index.within(PositionArray(queries), radius)
+    assert offsets.shape == (51,)
+    for i in range(50):
+        expected = order[i][distances[i][order[i]] <= radius]
+        assert (found[offsets[i] : offsets[i + 1]] == expected).all()
+        assert found_distances[offsets[i] : offsets[i + 1]] == pytest.approx(distances[i][expected], abs=1e-6)
+
+    indices, nearest = PositionIndex(points[:3]).nearest(queries[:1], count=4)
+    assert indices[0, 3] == -1
+    assert np.isinf(nearest[0, 3])
+    with pytest.raises(ValueError):
+        index.nearest(queries, count=0)
+
+
+def test_track_reader_csv(tmp_path):
+    path = tmp_path / "track.csv"
+    rows = [
+        "2024-03-01T12:00:00Z,52.0,4.0",
+        "2024-03-01T13:00:00+01:00,52.1,4.1",
+        "bad,52.2,4.2",
+        "2024-03-01T12:00:30.5,52.2,4.2",
+        "1709294460,52.3,4.3",
+        "2024-03-01T12:01:30,91.0,4.4",
+    ]
+    path.write_text("time,latitude,longitude\n" + "\n".join(rows) + "\n")
+    reader = TrackReader(str(path), chunk_size=2, legs=True)
+    chunks = list(reader)
+    assert [len(chunk["times"]) for chunk in chunks] == [2, 2]
+    assert reader.skipped == 2
+    times = np.concatenate([chunk["times"] for chunk in chunks])
+    assert times.tolist() == [1709294400.0, 1709294400.0, 1709294430.5, 1709294460.0]
+    distances = np.concatenate([chunk["distances"] for chunk in chunks])
+    azimuths = np.concatenate([chunk["azimuths"] for chunk in chunks])
+    assert np.isnan(distances[0])
+    expected = geodesic_inverse_batch([52.0, 52.1, 52.2], [4.0, 4.1, 4.2], [52.1, 52.2, 52.3], [4.1, 4.2, 4.3])
+    assert distances[1:] == pytest.approx(expected[:, 1])
+    assert azimuths[1:] == pytest.approx(angle_mod(expected[:, 0]))
+
+    reader = TrackReader(str(path), time_column=None, latitude_column="latitude")
+    chunk = next(reader)
+    assert np.isnan(chunk["times"]).all()
+    assert chunk["latitudes"].tolist() == [52.0, 52.1, 52.2, 52.2, 52.3]
+    with pytest.raises(ValueError):
+        TrackReader(str(path), latitude_column="lat")
+
+
+def test_track_reader_nmea(tmp_path):
+    def sentence(body):
+        checksum = 0
+        for c in body.encode():
+            checksum ^= c
+        return f"${body}*{checksum:02X}"
+
+    path = tmp_path / "track.nmea"
+    lines = [
+        sentence("GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W"),
+        sentence("GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,"),
+        sentence("GPGSV,2,1,08,01,40,083,46,02,17,308,41,12,07,344,39,14,22,228,45"),
+        sentence("GPGGA,123520,4807.138,N,01131.100,E,1,08,0.9,545.4,M,46.9,M,,"),
+        sentence("GPRMC,123521,V,4807.238,N,01131.200,E,022.4,084.4,230394,003.1,W"),
+        "$GPGGA,123522,4807.338,N,01131.300,E,1,08,0.9,545.4,M,46.9,M,,*00",
+    ]
+    path.write_text("\r\n".join(lines))
+    reader = TrackReader(str(path), format="nmea", legs=True, metric="rhumb")
+    chunk = next(reader)
+    with pytest.raises(StopIteration):
+        next(reader)
+    assert reader.skipped == 1
+    assert chunk["latitudes"] == pytest.approx([48 + 7.038 / 60, 48 + 7.138 / 60])
+    assert chunk["longitudes"] == pytest.approx([11 + 31.0 / 60, 11 + 31.1 / 60])
+    assert chunk["times"].tolist() == [764426119.0, 764426120.0]
+    assert chunk["distances"][1] == pytest.approx(
+        rhumb_inverse(chunk["latitudes"][0], chunk["longitudes"][0], chunk["latitudes"][1], chunk["longitudes"][1])[1]
+    )
+
+    # GGA before the first RMC has no date, GGA after midnight takes the next
+    lines = [
+        sentence("GPGGA,235958,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,"),
+        sentence("GPRMC,235959,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W"),
+        sentence("GPGGA,235959,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,"),
+        sentence("GPGGA,000000,4807.138,N,01131.100,E,1,08,0.9,545.4,M,46.9,M,,"),
+        sentence("GPRMC,000000,A,4807.138,N,01131.100,E,022.4,084.4,240394,003.1,W"),
+        sentence("GPGGA,000001,4807.238,N,01131.200,E,1,08,0.9,545.4,M,46.9,M,,"),
+    ]
+    path.write_text("\n".join(lines))
+    chunk = next(TrackReader(str(path), format="nmea"))
+    assert chunk["times"].tolist() == [764467199.0, 764467200.0, 764467201.0]
+
+
+def test_track_metrics():
+    times = np.array([0.0, 60.0, 120.0, 180.0, 0.0, 30.0, 60.0])
+    latitudes = np.array([52.0, 52.01, 52.02, 52.02, 10.0, 10.0, 10.01])
+    longitudes = np.array([4.0, 4.0, 4.01, 4.03, 20.0, 20.01, 20.01])
+    ids = np.array([1, 1, 1, 1, 2, 2, 2])
+    metrics = track_metrics(times, latitudes, longitudes, ids=ids, threads=2)
+    legs = geodesic_inverse_batch(latitudes[:-1], longitudes[:-1], latitudes[1:], longitudes[1:])
+    first = [0, 4]
+    for key in ("distances", "azimuths", "final_azimuths", "speeds", "turn_rates"):
+        assert np.isnan(metrics[key][first]).all()
+    rest = [1, 2, 3, 5, 6]
+    assert metrics["distances"][rest] == pytest.approx(legs[np.array(rest) - 1, 1])
+    assert metrics["azimuths"][rest] == pytest.approx(angle_mod(legs[np.array(rest) - 1, 0]))
+    assert metrics["final_azimuths"][rest] == pytest.approx(angle_mod(legs[np.array(rest) - 1, 2]))
+    assert metrics["speeds"][1] == pytest.approx(legs[0, 1] / 60)
+    assert metrics["speeds"][5] == pytest.approx(legs[4, 1] / 30)
+    assert metrics["cumulative_distances"][:4] == pytest.approx(np.cumsum([0, *legs[:3, 1]]))
+    assert metrics["cumulative_distances"][4:] == pytest.approx(np.cumsum([0, *legs[4:, 1]]))
+    assert metrics["courses"][0] == pytest.approx(metrics["azimuths"][1])
+    assert metrics["courses"][2] == pytest.approx(metrics["final_azimuths"][2])
+    turn = angle_mod_signed(metrics["courses"][6] - metrics["courses"][5]) / 30
+    assert metrics["turn_rates"][6] == pytest.approx(turn)
+    assert metrics["turn_rates"][6] < -1.0
+
+    rhumbs = track_metrics(times[:4], latitudes[:4], longitudes[:4], metric="rhumb")
+    assert rhumbs["distances"][1:] == pytest.approx(rhumb_inverse_batch(
+        latitudes[:3], longitudes[:3], latitudes[1:4], longitudes[1:4])[:, 1])
+    assert np.isnan(rhumbs["turn_rates"][1])
+    assert rhumbs["turn_rates"][2] == pytest.approx(angle_mod_signed(rhumbs["courses"][2] - rhumbs["courses"][1]) / 60)
+
+    # Repeated fixes keep the course and don't turn
+    times = np.arange(6) * 10.0
+    latitudes = np.array([52.0, 52.01, 52.01, 52.01, 52.02, 52.02])
+    longitudes = np.array([4.0, 4.0, 4.0, 4.0, 4.01, 4.01])
+    moored = track_metrics(times, latitudes, longitudes)
+    assert moored["distances"][[2, 3, 5]].tolist() == [0.0, 0.0, 0.0]
+    assert moored["courses"][1] == moored["courses"][2] == moored["courses"][3]
+    assert moored["courses"][5] == moored["courses"][4]
+    assert np.isnan(moored["turn_rates"][:4]).all()
+    turn = angle_mod_signed(moored["courses"][4] - moored["courses"][3]) / 10
+    assert moored["turn_rates"][4] == pytest.approx(turn)
+    assert moored["turn_rates"][5] == 0.0
+    with pytest.raises(ValueError):
+        track_metrics(times, latitudes, longitudes[:3])
+
+
+def test_simplify():
+    track = geodesic_direct_batch(52.0, 4.0, 60.0, np.arange(100) * 1000.0)
+    latitudes = track[:, 0].copy()
+    longitudes = track[:, 1].copy()
+    assert simplify(latitudes, longitudes, 1.0).tolist() == [0, 99]
+
+    lat, lon, _ = geodesic_direct(latitudes[50], longitudes[50], track[50, 2] + 90, 100.0)
+    latitudes[50] = lat
+    longitudes[50] = lon
+    assert simplify(latitudes, longitudes, 10.0).tolist() == [0, 49, 50, 51, 99]
+    assert simplify(latitudes, longitudes, 101.0).tolist() == [0, 99]
+
+    ids = np.repeat([7, 8], 100)
+    both = simplify(np.tile(latitudes, 2), np.tile(longitudes, 2), 10.0, ids=ids, threads=2)
+    assert both.tolist() == [0, 49, 50, 51, 99, 100, 149, 150, 151, 199]
+    with pytest.raises(ValueError):
+        simplify(latitudes, longitudes, -1.0)
+
+
+def test_cross_track():
+    cross, along = cross_track(Position(0.0, 0.0), Position(0.0, 10.0), Position(1.0, 5.0))
+    assert cross == pytest.approx(-geodesic_inverse(0, 5, 1, 5)[1], abs=1e-3)
+    assert along == pytest.approx(geodesic_inverse(0, 0, 0, 5)[1], abs=1e-3)
+
+    start = Position(50.0, 0.0)
+    end = Position(50.0, 10.0)
+    cross, along = cross_track(start, end, Position(50.0, 5.0), kind="loxo")
+    assert cross == pytest.approx(0.0, abs=1e-3)
+    assert along == pytest.approx(rhumb_inverse(50, 0, 50, 5)[1], abs=1e-3)
+    cross, along = cross_track(start, end, Position(50.0, 5.0))
+    assert cross > 10000
+
+    latitudes = np.array([50.0, 51.0, 49.0, 50.0])
+    longitudes = np.array([5.0, 2.0, 8.0, 12.0])
+    result = cross_track_batch(50.0, 0.0, 50.0, 10.0, latitudes, longitudes, kind="loxo", threads=2)
+    assert result.shape == (4, 2)
+    for (lat, lon), value in zip(zip(latitudes, longitudes), result):
+        expected = cross_track(start, end, Position(lat, lon), "loxo")
+        assert value == pytest.approx(expected)
+    assert result[1, 0] < 0 < result[2, 0]
+    assert result[3, 1] > rhumb_inverse(50, 0, 50, 10)[1]
+    with pytest.raises(ValueError):
+        cross_track(start, end, Position(50.0, 5.0), kind="arc")
+
+
+def test_cpa():
+    tcpa, dcpa = cpa(Position(0.0, 0.0), Vector(90, 10.0), Position(0.0, 0.1), Vector(270, 10.0))
+    assert tcpa == pytest.approx(geodesic_inverse(0, 0, 0, 0.1)[1] / 20)
+    assert dcpa == pytest.approx(0.0, abs=1e-6)
+    tcpa, dcpa = cpa(Position(0.0, 0.0), Vector(90, 10.0), Position(0.01, 0.1), Vector(270, 10.0))
+    assert dcpa == pytest.approx(geodesic_inverse(0, 0, 0.01, 0)[1], rel=1e-3)
+    tcpa, dcpa = cpa(Position(52.0, 4.0), Vector(45, 5.0), Position(52.1, 4.0), Vector(45, 5.0))
+    assert tcpa == 0.0
+    assert dcpa == pytest.approx(geodesic_inverse(52, 4, 52.1, 4)[1])
+    tcpa, dcpa = cpa(Position(0.0, 0.0), Vector(270, 10.0), Position(0.0, 0.1), Vector(90, 10.0))
+    assert tcpa < 0
+
+    result = cpa_batch(0.0, 0.0, 90.0, 10.0, [0.0, 0.01], 0.1, 270.0, 10.0, threads=2)
+    assert result.shape == (2, 2)
+    assert result[1] == pytest.approx(
+        cpa(Position(0.0, 0.0), Vector(90, 10.0), Position(0.01, 0.1), Vector(270, 10.0))
+    )
+
+
+def test_polygon():
+    square = np.array([[0.0, 0.0], [0.0, 1.0], [1.0, 1.0], [1.0, 0.0]])
+    polygon = Polygon(square)
+    assert len(polygon) == 4
+    assert polygon.latitudes.tolist() == [0.0, 0.0, 1.0, 1.0]
+    perimeter = sum(geodesic_inverse(*square[i - 1], *square[i])[1] for i in range(4))
+    assert polygon.perimeter() == pytest.approx(perimeter)
+    assert polygon.area() == pytest.approx(1.2308e10, rel=1e-3)
+    assert Polygon(square[::-1]).area() == pytest.approx(polygon.area())
+    assert polygon.area("loxo") == pytest.approx(polygon.area(), rel=1e-3)
+    assert polygon.contains(Position(0.5, 0.5))
+    assert not polygon.contains(Position(0.5, 1.5))
+    for kind in ("ortho", "loxo"):
+        inside = polygon.contains(np.array([[0.5, 0.5], [0.5, 360.5], [1.5, 0.5], [-0.5, 0.5]]), kind, threads=2)
+        assert inside.tolist() == [True, True, False, False]
+
+    # Geodesic edges bulge poleward of the parallel that loxodromes follow
+    north = Polygon(np.array([[60.0, 0.0], [60.0, 10.0], [50.0, 5.0]]))
+    assert north.contains(Position(60.05, 5.0))
+    assert not north.contains(Position(60.05, 5.0), "loxo")
+    assert not north.contains(Position(60.15, 5.0))
+
+    # Across the antimeridian
+    pacific = Polygon(PositionArray(np.array([[-10.0, 170.0], [-10.0, -170.0], [10.0, -170.0], [10.0, 170.0]])))
+    assert pacific.contains(np.array([[0.0, 180.0], [0.0, -175.0], [0.0, 175.0], [0.0, 0.0]])).tolist() == [
+        True, True, True, False]
+
+    # Around the south pole
+    antarctic = Polygon(np.array([[-70.0, lon] for lon in range(0, 360, 30)]))
+    assert antarctic.contains(np.array([[-80.0, 45.0], [-90.0, 0.0], [-60.0, 45.0], [80.0, 45.0]])).tolist() == [
+        True, True, False, False]
+
+    # Many vertices use several bands of the index
+    angles = np.linspace(0, 2 * np.pi, 1000, endpoint=False)
+    circle = Polygon(np.column_stack((10 * np.sin(angles), 10 * np.cos(angles))))
+    rng = np.random.default_rng(5)
+    points = np.column_stack((rng.uniform(-12, 12, 5000), rng.uniform(-12, 12, 5000)))
+    expected = np.hypot(points[:, 0], points[:, 1]) < 9.99
+    assert (circle.contains(points)[expected]).all()
+    assert not circle.contains(points)[np.hypot(points[:, 0], points[:, 1]) > 10.1].any()
+
+    with pytest.raises(ValueError):
+        Polygon(square[:2])
+    with pytest.raises(ValueError):
+        polygon.area("great circle")
+
+
+def test_projector():
+    origin = Position(52.0, 4.0)
+    lat, lon, _ = geodesic_direct(52.0, 4.0, 45.0, 10000.0)
+    expected = 10000.0 * np.sqrt(0.5)
+    rng = np.random.default_rng(7)
+    positions = np.column_stack((rng.uniform(51.5, 52.5, 100), rng.uniform(3.5, 4.5, 100)))
+    for kind, tolerance in (("local", 0.1), ("transverse_mercator", 1.0), ("azimuthal_equidistant", 1e-6)):
+        projector = Projector(origin, kind)
+        assert projector.origin == origin
+        assert tuple(projector.forward(origin)) == pytest.approx((0.0, 0.0), abs=1e-6)
+        point = projector.forward(Position(lat, lon))
+        assert point.x == pytest.approx(expected, abs=tolerance)
+        assert point.y == pytest.approx(expected, abs=tolerance)
+        assert tuple(projector.reverse(point)) == pytest.approx((lat, lon), abs=1e-9)
+
+        points = projector.forward(PositionArray(positions), threads=2)
+        assert points.shape == (100, 2)
+        assert tuple(points[3]) == pytest.approx(tuple(projector.forward(Position(*positions[3]))))
+        out = np.empty((100, 2))
+        assert projector.reverse(points, out=out) is out
+        assert out == pytest.approx(positions, abs=1e-9)
+
+    with pytest.raises(ValueError):
+        Projector(origin, "mercator")
+    with pytest.raises(ValueError):
+        Projector(origin).reverse(np.zeros((3, 3)))
+
+
+def test_grid_references():
+    latitudes = np.array([52.0, 57.64911, -33.9, 89.5, np.nan])
+    longitudes = np.array([4.0, 10.40744, 18.4, 10.0, 0.0])
+
+    zones, north, coordinates = utm_encode(latitudes, longitudes, threads=2)
+    assert zones.tolist() == [31, 32, 34, 0, -4]
+    assert north.tolist()[:4] == [True, True, False, True]
+    assert coordinates.shape == (5, 2)
+    assert coordinates[0, 0] > 500000.0
+    assert np.isnan(coordinates[4]).all()
+    positions = utm_decode(zones, north, coordinates)
+    assert positions[:4] == pytest.approx(np.column_stack((latitudes, longitudes))[:4], abs=1e-9)
+    assert np.isnan(positions[4]).all()
+
+    hashes = geohash_encode(latitudes, longitudes, length=11)
+    assert hashes.dtype == np.dtype("S11")
+    assert hashes[1] == b"u4pruydqqvj"
+    assert hashes[4] == b""
+    positions = geohash_decode(hashes)
+    assert positions[:4] == pytest.approx(np.column_stack((latitudes, longitudes))[:4], abs=1e-5)
+    assert np.isnan(positions[4]).all()
+    assert geohash_decode(["u4pruydqqvj", "invalid!"])[0] == pytest.approx([57.64911, 10.40744], abs=1e-5)
+    assert np.isnan(geohash_decode(["u4pruydqqvj", "invalid!"])[1]).all()
+
+    references = mgrs_encode(latitudes, longitudes, precision=5, threads=2)
+    assert references.dtype == np.dtype("S15")
+    assert references[0].startswith(b"31U")
+    assert references[4] == b""
+    positions = mgrs_decode(references)
+    assert positions[:4] == pytest.approx(np.column_stack((latitudes, longitudes))[:4], abs=1e-3)
+    assert np.isnan(positions[4]).all()
+
+    with pytest.raises(ValueError):
+        geohash_encode(latitudes, longitudes, length=19)
+    with pytest.raises(ValueError):
+        mgrs_encode(latitudes, longitudes[:2])
+
+
+def test_intersection():
+    for kind in ("ortho", "loxo"):
+        west, east = Position(0.0, -1.0), Position(0.0, 1.0)
+        position = intersection(west, east, Position(-1.0, 0.5), Position(1.0, 0.5), kind)
+        assert tuple(position) == pytest.approx((0.0, 0.5), abs=1e-9)
+        assert intersection(west, east, Position(1.0, 0.0), Position(2.0, 0.0), kind) is None
+        west, east = Position(10.0, 179.0), Position(10.0, -179.0)
+        position = intersection(west, east, Position(9.0, 180.0), Position(11.0, 180.0), kind)
+        assert abs(position.longitude) == pytest.approx(180.0)
+
+    # A loxodrome keeps its course, so crossing a meridian it has the latitude at that longitude
+    start, end = Position(50.0, -5.0), Position(55.0, 10.0)
+    position = intersection(start, end, Position(40.0, 0.0), Position(60.0, 0.0), "loxo")
+    azimuth, _, _ = rhumb_inverse(start.latitude, start.longitude, end.latitude, end.longitude)
+    azimuth1, _, _ = rhumb_inverse(start.latitude, start.longitude, position.latitude, position.longitude)
+    assert azimuth1 == pytest.approx(azimuth, abs=1e-7)
+    assert position.longitude == pytest.approx(0.0, abs=1e-9)
+    # Also on a prolate ellipsoid, whose eccentricity is imaginary
+    prolate = Ellipsoid(6378137.0, -1 / 150)
+    position = intersection(start, end, Position(40.0, 0.0), Position(60.0, 0.0), "loxo", prolate)
+    azimuth, _, _ = rhumb_inverse(start.latitude, start.longitude, end.latitude, end.longitude, prolate)
+    azimuth1, _, _ = rhumb_inverse(start.latitude, start.longitude, position.latitude, position.longitude, prolate)
+    assert azimuth1 == pytest.approx(azimuth, abs=1e-7)
+
+    route = np.array([[0.0, 0.0], [0.0, 4.0], [1.0, 8.0], [1.0, 12.0]])
+    segments = np.array([
+        [-1.0, 10.0, 2.0, 10.0],
+        [-1.0, 2.0, 2.0, 2.0],
+        [-1.0, 6.0, 2.0, 6.0],
+        [-1.0, 3.0, -0.5, 3.0],
+        [40.0, 2.0, 41.0, 2.0],
+        [-1.0, 1.0, 1.0, 3.0],
+    ])
+    for kind in ("ortho", "loxo"):
+        legs, indices, positions = route_intersections(PositionArray(route), segments, kind, threads=2)
+        assert legs.tolist() == [0, 0, 1, 2]
+        assert sorted(indices[:2].tolist()) == [1, 5]
+        assert indices[2:].tolist() == [2, 0]
+        assert positions.shape == (4, 2)
+        for leg, index, position in zip(legs, indices, positions):
+            expected = intersection(Position(*route[leg]), Position(*route[leg + 1]),
+                                    Position(*segments[index, :2]), Position(*segments[index, 2:]), kind)
+            assert tuple(position) == pytest.approx(tuple(expected))
+
+    legs, indices, positions = route_intersections(route[:1], segments)
+    assert len(legs) == 0
+    with pytest.raises(ValueError):
+        route_intersections(route, segments[:, :3])
+
+
 def test_point():
     p1 = Point(1, 8.88)
     p2 = Point((1, 8.88))
@@ -166,6 +802,51 @@ def test_string_construction(log):
     assert p.longitude == pytest.approx(1.0 / 120.0)
 
 
+def test_parse_positions():
+    records = [
+        "52.1 4.1",
+        "40°38′23″N 73°46′44″W",
+        "7200 3600",
+        "4.1W 12.0N",
+        "-89°30.5S 00°00.50",
+        "52.123456789 4.987654321",
+        "no position",
+        "1 2 3",
+    ]
+    values, valid = parse_positions(records)
+    assert values.shape == (8, 2)
+    assert valid.tolist() == [True] * 6 + [False] * 2
+    for record, value in zip(records[:6], values):
+        p = Position(record)
+        assert value[0] == p.latitude
+        assert value[1] == p.longitude
+    assert values[5, 0] == 52.123456789
+    assert np.isnan(values[6:]).all()
+
+    buffer = "\n".join(records).encode() + b"\n"
+    from_bytes, valid_bytes = parse_positions(buffer, threads=2)
+    assert (valid_bytes == valid).all()
+    assert from_bytes[valid] == pytest.approx(values[valid])
+    from_bytearray, _ = parse_positions(bytearray(buffer))
+    assert from_bytearray[valid] == pytest.approx(values[valid])
+    from_tuple, _ = parse_positions(tuple(records))
+    assert from_tuple[valid] == pytest.approx(values[valid])
+    # A single string is a record per line, not per character
+    from_string, valid_string = parse_positions(records[1])
+    assert valid_string.tolist() == [True]
+    assert from_string[0].tolist() == [values[1, 0], values[1, 1]]
+
+    values, valid = parse_positions(
+        b"5212.3456,N,00412.3456,E\r\n4012.0000,S,07330.0000,W\n9112.0,N,00000.0,E\n5212.3,N,004,X\n",
+        format="nmea",
+    )
+    assert valid.tolist() == [True, True, False, False]
+    assert values[0] == pytest.approx((52 + 12.3456 / 60, 4 + 12.3456 / 60))
+    assert values[1] == pytest.approx((-40.2, -73.5))
+    with pytest.raises(ValueError):
+        parse_positions(records, format="utm")
+
+
 def test_repr_and_str(log):
     p = Point(3.131313, 5.151515)
     assert str(p) == "3.131, 5.152"
@@ -217,6 +898,129 @@ def test_numpy():
     assert (a.T == [[p1[0], p2[0]], [p1[1], p2[1]]]).all()
 
 
+def test_vector_array():
+    vectors = VectorArray([Vector(0, 1), Vector(90, 1), Vector(270, -2)])
+    assert len(vectors) == 3
+    assert vectors[1] == Vector(90, 1)
+    assert vectors[-1] == Vector(90, 2)
+    assert (vectors.azimuths == [0, 90, 90]).all()
+    assert (vectors.lengths == [1, 1, 2]).all()
+    a = np.asarray(vectors)
+    assert a.shape == (2, 3)
+    assert (a[0] == vectors.azimuths).all()
+    with pytest.raises(ValueError):
+        vectors.azimuths[0] = 1.0
+    with pytest.raises(IndexError):
+        vectors[3]
+    doubled = vectors * 2
+    assert doubled[2] == Vector(90, 4)
+    summed = vectors + VectorArray(np.array([90.0, 0.0, 0.0]), np.ones(3))
+    assert summed[0] == Vector(0, 1) + Vector(90, 1)
+    assert (-vectors)[0] == -Vector(0, 1)
+    # Adding or subtracting an angle rotates, like it does for Vector
+    for rotated, expected in (
+        (vectors + 10.0, Vector(90, 1) + 10.0),
+        (10.0 + vectors, 10.0 + Vector(90, 1)),
+        (vectors - 10.0, Vector(90, 1) - 10.0),
+        (10.0 - vectors, 10.0 - Vector(90, 1)),
+    ):
+        assert rotated[1] == expected
+    rotated = VectorArray(vectors)
+    rotated += 10.0
+    rotated -= 10.0
+    assert rotated == vectors
+    assert not (doubled == vectors)
+    with pytest.raises(ValueError):
+        VectorArray(np.zeros(3), np.zeros(2))
+
+
+def test_position_array():
+    lats = np.array([52.0, -10.0, 45.0])
+    lons = np.array([4.0, 190.0, 1.0])
+    positions = PositionArray(lats, lons)
+    assert len(positions) == 3
+    assert positions[1] == Position(-10.0, -170.0)
+    assert positions.longitudes[1] == pytest.approx(-170.0)
+    assert np.asarray(positions).shape == (2, 3)
+    positions[2] = Position(44.0, 1.0)
+    assert positions[2] == Position(44.0, 1.0)
+    assert repr(positions) == "PositionArray(3 positions)"
+
+    v = Vector(45, 10000)
+    for op in (
+        lambda p, v: p + v,
+        lambda p, v: p - v,
+        lambda p, v: p * v,
+        lambda p, v: p / v,
+    ):
+        result = op(positions, v)
+        assert isinstance(result, PositionArray)
+        for i in range(3):
+            assert result[i] == op(positions[i], v)
+
+    vectors = VectorArray([Vector(45, 1e4), Vector(90, 2e4), Vector(180, 3e4)])
+    moved = positions * vectors
+    for i in range(3):
+        assert moved[i] == positions[i] * vectors[i]
+    back = moved / positions
+    for i in range(3):
+        assert back[i] == moved[i] / positions[i]
+    rhumbs = positions - positions[0]
+    assert isinstance(rhumbs, VectorArray)
+    for i in range(3):
+        assert rhumbs[i] == positions[i] - positions[0]
+    reverse = positions[0] / positions
+    for i in range(3):
+        assert reverse[i] == positions[0] / positions[i]
+
+    moved = positions.copy()
+    moved += vectors
+    moved -= vectors
+    for i in range(3):
+        assert moved[i] == positions[i]
+
+    with pytest.raises(ValueError):
+        positions + VectorArray(2)
+
+    p = pickle.loads(pickle.dumps(positions))
+    assert (np.asarray(p) == np.asarray(positions)).all()
+
+
+def test_buffer_protocol():
+    pos = Position(52.0, 4.0)
+    a = np.asarray(pos)
+    assert a.dtype == np.float64
+    assert (a == [52.0, 4.0]).all()
+    with pytest.raises(ValueError):
+        a[0] = 1.0
+    pos.latitude = 53.0
+    assert a[0] == 53.0
+    assert (np.asarray(Vector(45, 10)) == [45, 10]).all()
+    p = Point(1.0, 2.0)
+    a = np.asarray(p)
+    a[1] = 3.0
+    assert p.y == 3.0
+    positions = np.array([Position(52.0, 4.0), Position(53.0, 5.0)])
+    assert positions.shape == (2, 2)
+    assert (positions[1] == [53.0, 5.0]).all()
+
+    assert Position(np.array([52.0, 4.0])) == Position(52.0, 4.0)
+    assert Vector(np.array([90.0, -1.0])) == Vector(270.0, 1.0)
+    assert Point(np.array([1.0, 2.0], dtype=np.float32)) == Point(1.0, 2.0)
+    with pytest.raises(IndexError):
+        Position(np.array([52.0, 4.0, 3.0]))
+
+    values = np.array([[52.0, 4.0], [53.0, 365.0], [45.0, 1.0]])
+    positions = PositionArray(values)
+    assert len(positions) == 3
+    assert positions[1] == Position(53.0, 5.0)
+    assert (positions.latitudes == values[:, 0]).all()
+    vectors = VectorArray(values)
+    assert vectors[1] == Vector(53.0, 365.0)
+    with pytest.raises(ValueError):
+        PositionArray(values.T)
+
+
 def test_pickling():
     p = Position(1.0, 1.0)
     with open("test.pickle", "wb") as f:
@@ -243,3 +1047,42 @@ def test_vector_split_ortho():
     assert len(result) == 11
     assert result[0] == JFK
     assert result[-1] == AMS
+    legs = [p2 / p1 for p1, p2 in zip(result[:-1], result[1:])]
+    for leg in legs:
+        assert leg.length == pytest.approx(legs[0].length, abs=1e-6)
+
+
+def test_vector_split_arrays():
+    JFK = Position("40°38′23″N 73°46′44″W")
+    AMS = Position("52°18′00″N 4°45′54″E")
+    loxo = AMS - JFK
+    result = loxo.split_loxo_array(JFK, 10)
+    assert result.shape == (11, 2)
+    for p, q in zip(result, loxo.split_loxo(JFK, 10)):
+        assert Position(p) == q
+    assert Position(result[-1]) == AMS
+    ortho = AMS / JFK
+    result = ortho.split_ortho_array(JFK, 10)
+    assert result.shape == (11, 2)
+    for p, q in zip(result, ortho.split_ortho(JFK, 10)):
+        assert Position(p) == q
+    assert Position(result[-1]) == AMS
+
+
+def test_vector_sample_ortho():
+    JFK = Position("40°38′23″N 73°46′44″W")
+    AMS = Position("52°18′00″N 4°45′54″E")
+    vector = AMS / JFK
+    result = vector.sample_ortho(JFK, 10000.0)
+    assert result.shape == (int(np.ceil(vector.length / 10000.0)) + 1, 2)
+    assert Position(result[0]) == JFK
+    assert Position(result[-1]) == AMS
+    for p1, p2 in zip(result[:-2], result[1:-1]):
+        assert (Position(p2) / Position(p1)).length == pytest.approx(10000.0, abs=1e-6)
+    assert (Position(result[-1]) / Position(result[-2])).length <= 10000.0
+    with pytest.raises(ValueError):
+        vector.sample_ortho(JFK, 0.0)
+    with pytest.raises(ValueError):
+        vector.sample_ortho(JFK, 1e-300)
+    with pytest.raises(ValueError):
+        Vector(0.0, np.inf).sample_ortho(JFK, 10000.0)